@@ -10,6 +10,27 @@
  */
 
 #include "matrix.h"     // Linear algebra's matrices
+#include "triangular.h" // Lower and upper triangular matrices -- packed storage
+#include "exponentiation.h" // Addition chains -- fewest multiplications for powers
+#include "kernels.h"    // Dense GEMM and TRSM kernels
+#include "strassen.h"   // Strassen's fast multiplication -- sub-cubic kernels
+#include "lu.h"         // PA = LU factorization kernels
+#include "lu_factorization.h" // Reusable LU factorization -- determinant, solve, inverse
+#include "cholesky.h"   // A = R^T R factorization kernels
+#include "cholesky_factorization.h" // Reusable Cholesky factorization -- SPD matrices
+#include "qr.h"         // Householder QR kernels -- compact WY form
+#include "qr_factorization.h" // Reusable QR factorization -- least squares
+#include "incremental.h"// Determinant and inverse under row/column replacements
+#include "mixed_precision.h" // Float LU with iterative refinement in double
+#include "companion.h"  // Companion matrices -- powers of linear recurrences
+#include "power_cache.h" // Many powers of one matrix -- shared squarings
+#include "matrix_chain.h" // Products of chains of matrices -- optimal order
+#include "matrix_functions.h" // Matrix polynomials and exponential
+#include "parallel.h"   // Task graph scheduler for the multithreaded algorithms
+#include "integer.h"    // Exact determinants of integer matrices
+#include "modular.h"    // Arithmetic modulo word-size primes
+#include "big_integer.h"// Arbitrary precision integers
+#include "batched.h"    // Batches of small matrices
 #include "vector_2d.h"  // 2-Dimensional vectors
 #include "vector_3d.h"  // 3-Dimensional vectors -- vector_2D derived class
 #include "complex.h"    // Complex numbers
@@ -0,0 +1,251 @@
+#ifndef BATCHED_H
+#define BATCHED_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "parallel.h"   // Threads over the batch
+
+
+/*                    BATCHED SMALL MATRICES
+ *
+ *  Kernels over batches of small square matrices, stored back to back
+ *  in one contiguous array, each one row-major (a batch of N x N matrices
+ *  is an array of count * N * N scalars). They avoid the allocation and
+ *  the generic algorithms of sqr_matrix, which dominate the cost for
+ *  matrices this small.
+ *
+ *  The determinants use the closed-form cofactor expansions. Every
+ *  iteration of their loops is independent and branch-free, so the
+ *  compiler vectorizes them across the batch, and the batch is split
+ *  among the threads in chunks of BATCH_GRAIN matrices.
+ *
+ *  The ordered product M0 M1 ... M(count-1) of a batch and all of its
+ *  prefix products, as in transfer matrix methods or the forward pass of
+ *  hidden Markov models, are associative but not commutative reductions:
+ *  the batch is cut into consecutive chunks, one task each, whose
+ *  products are computed concurrently and then combined in order. The
+ *  scan takes two passes, the chunk products first, then every chunk
+ *  again, starting from the product of all the chunks before it, so it
+ *  does twice the multiplications of a serial fold but in parallel. The
+ *  multiplications of 2x2, 3x3 and 4x4 matrices are fully unrolled and
+ *  no memory is allocated per step.
+ */
+
+namespace algebra {
+    const std::size_t BATCH_GRAIN = 1 << 16;   // Matrices per task
+
+    template <typename T> void determinants2x2(const T *, std::size_t, T *, unsigned int threads = 0);
+    template <typename T> void determinants3x3(const T *, std::size_t, T *, unsigned int threads = 0);
+    template <typename T> void determinants4x4(const T *, std::size_t, T *, unsigned int threads = 0);
+    template <typename T> void productOfBatch(const T *, std::size_t, std::size_t, T *, unsigned int threads = 0);
+    template <typename T> void prefixProducts(const T *, std::size_t, std::size_t, T *, unsigned int threads = 0);
+
+
+    // --- BLUEPRINTS ---
+
+    // Writes the determinants of count 2x2 matrices into dets
+    template <typename T>
+    void determinants2x2(const T *matrices, std::size_t count, T *dets, unsigned int threads) {
+        parallelFor(count, BATCH_GRAIN, [=](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const T *m = matrices + 4 * i;
+                dets[i] = m[0] * m[3] - m[1] * m[2];
+            }
+        }, threads);
+    }
+
+    // Writes the determinants of count 3x3 matrices into dets, expanding along the first row
+    template <typename T>
+    void determinants3x3(const T *matrices, std::size_t count, T *dets, unsigned int threads) {
+        parallelFor(count, BATCH_GRAIN, [=](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const T *m = matrices + 9 * i;
+                dets[i] = m[0] * (m[4] * m[8] - m[5] * m[7])
+                        - m[1] * (m[3] * m[8] - m[5] * m[6])
+                        + m[2] * (m[3] * m[7] - m[4] * m[6]);
+            }
+        }, threads);
+    }
+
+    /*  Writes the determinants of count 4x4 matrices into dets. Laplace expansion
+     *  along the first two rows: the six 2x2 minors of the top rows times their
+     *  complementary minors of the bottom rows, 30 multiplications in total.
+     */
+    template <typename T>
+    void determinants4x4(const T *matrices, std::size_t count, T *dets, unsigned int threads) {
+        parallelFor(count, BATCH_GRAIN, [=](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const T *m = matrices + 16 * i;
+
+                // Minors of rows 0 and 1, columns (0,1) (0,2) (0,3) (1,2) (1,3) (2,3)
+                T s0 = m[0] * m[5] - m[1] * m[4];
+                T s1 = m[0] * m[6] - m[2] * m[4];
+                T s2 = m[0] * m[7] - m[3] * m[4];
+                T s3 = m[1] * m[6] - m[2] * m[5];
+                T s4 = m[1] * m[7] - m[3] * m[5];
+                T s5 = m[2] * m[7] - m[3] * m[6];
+
+                // Minors of rows 2 and 3, complementary columns (2,3) (1,3) (1,2) (0,3) (0,2) (0,1)
+                T c5 = m[10] * m[15] - m[11] * m[14];
+                T c4 = m[9] * m[15] - m[11] * m[13];
+                T c3 = m[9] * m[14] - m[10] * m[13];
+                T c2 = m[8] * m[15] - m[11] * m[12];
+                T c1 = m[8] * m[14] - m[10] * m[12];
+                T c0 = m[8] * m[13] - m[9] * m[12];
+
+                dets[i] = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+            }
+        }, threads);
+    }
+
+    // C = A * B, of fixed size N x N, C apart from both
+    template <std::size_t N, typename T>
+    void multiplySmall(const T *A, const T *B, T *C) {
+        for (std::size_t i = 0; i < N; ++i) {
+            for (std::size_t j = 0; j < N; ++j) {
+                T sum = A[i * N] * B[j];
+                for (std::size_t k = 1; k < N; ++k) {
+                    sum += A[i * N + k] * B[k * N + j];
+                }
+                C[i * N + j] = sum;
+            }
+        }
+    }
+
+    // C = A * B, of size N x N, C apart from both, unrolled for N <= 4
+    template <typename T>
+    void multiplySmall(std::size_t N, const T *A, const T *B, T *C) {
+        switch (N) {
+            case 1: C[0] = A[0] * B[0]; return;
+            case 2: multiplySmall<2>(A, B, C); return;
+            case 3: multiplySmall<3>(A, B, C); return;
+            case 4: multiplySmall<4>(A, B, C); return;
+            default: break;
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            T *row = C + i * N;
+            for (std::size_t j = 0; j < N; ++j) {
+                row[j] = A[i * N] * B[j];
+            }
+            for (std::size_t k = 1; k < N; ++k) {
+                T scalar = A[i * N + k];
+                for (std::size_t j = 0; j < N; ++j) {
+                    row[j] += scalar * B[k * N + j];
+                }
+            }
+        }
+    }
+
+    // Number of chunks a batch of count matrices is cut into, a few per thread
+    inline std::size_t batchChunks(std::size_t count, unsigned int threads) {
+        if (threads == 0) {
+            threads = defaultThreads();
+        }
+        std::size_t chunks = (count + BATCH_GRAIN - 1) / BATCH_GRAIN;
+        if (chunks > 4 * (std::size_t) threads) {
+            chunks = 4 * (std::size_t) threads;
+        }
+        return chunks == 0 ? 1 : chunks;
+    }
+
+    // product = M(begin) ... M(end - 1), of N x N matrices, end > begin, with two scratch buffers
+    template <typename T>
+    void productOfRange(const T *matrices, std::size_t begin, std::size_t end, std::size_t N, T *product,
+                        std::vector<T> &one, std::vector<T> &two) {
+        std::size_t size = N * N;
+
+        std::copy(matrices + begin * size, matrices + (begin + 1) * size, one.begin());
+        for (std::size_t i = begin + 1; i < end; ++i) {
+            multiplySmall(N, one.data(), matrices + i * size, two.data());
+            one.swap(two);
+        }
+        std::copy(one.begin(), one.end(), product);
+    }
+
+    /*  Writes the ordered product M0 M1 ... M(count-1) of count N x N
+     *  matrices into product (N x N), the identity for an empty batch.
+     */
+    template <typename T>
+    void productOfBatch(const T *matrices, std::size_t count, std::size_t N, T *product, unsigned int threads) {
+        std::size_t size = N * N;
+        std::size_t chunks = batchChunks(count, threads);
+
+        if (count == 0) {
+            for (std::size_t i = 0; i < size; ++i) {
+                product[i] = (T) (i % (N + 1) == 0 ? 1 : 0);
+            }
+            return;
+        }
+        if (chunks > count) {
+            chunks = count;
+        }
+
+        std::vector<T> partial(chunks * size);
+        parallelFor(chunks, 1, [&](std::size_t first, std::size_t last) {
+            std::vector<T> one(size), two(size);
+            for (std::size_t c = first; c < last; ++c) {
+                productOfRange(matrices, count * c / chunks, count * (c + 1) / chunks, N,
+                               partial.data() + c * size, one, two);
+            }
+        }, threads);
+
+        std::vector<T> one(size), two(size);
+        productOfRange(partial.data(), 0, chunks, N, product, one, two);
+    }
+
+    /*  Writes the prefix products P(i) = M0 M1 ... M(i) of count N x N
+     *  matrices into prefixes, count N x N matrices as well.
+     */
+    template <typename T>
+    void prefixProducts(const T *matrices, std::size_t count, std::size_t N, T *prefixes, unsigned int threads) {
+        std::size_t size = N * N;
+        std::size_t chunks = batchChunks(count, threads);
+
+        if (count == 0)
+            return;
+        if (chunks > count) {
+            chunks = count;
+        }
+
+        // Products of the chunks, each one but the last
+        std::vector<T> partial(chunks * size);
+        parallelFor(chunks - 1, 1, [&](std::size_t first, std::size_t last) {
+            std::vector<T> one(size), two(size);
+            for (std::size_t c = first; c < last; ++c) {
+                productOfRange(matrices, count * c / chunks, count * (c + 1) / chunks, N,
+                               partial.data() + c * size, one, two);
+            }
+        }, threads);
+
+        // Exclusive scan of the chunk products: carry c is the product of chunks 0 ... c - 1
+        std::vector<T> carry(chunks * size);
+        for (std::size_t c = 1; c < chunks; ++c) {
+            if (c == 1) {
+                std::copy(partial.begin(), partial.begin() + (std::ptrdiff_t) size, carry.begin() + (std::ptrdiff_t) size);
+            } else {
+                multiplySmall(N, carry.data() + (c - 1) * size, partial.data() + (c - 1) * size, carry.data() + c * size);
+            }
+        }
+
+        parallelFor(chunks, 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t c = first; c < last; ++c) {
+                std::size_t begin = count * c / chunks;
+                std::size_t end = count * (c + 1) / chunks;
+
+                if (c == 0) {
+                    std::copy(matrices, matrices + size, prefixes);
+                } else {
+                    multiplySmall(N, carry.data() + c * size, matrices + begin * size, prefixes + begin * size);
+                }
+                for (std::size_t i = begin + 1; i < end; ++i) {
+                    multiplySmall(N, prefixes + (i - 1) * size, matrices + i * size, prefixes + i * size);
+                }
+            }
+        }, threads);
+    }
+}
+
+
+#endif // BATCHED_H
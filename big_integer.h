@@ -0,0 +1,232 @@
+#ifndef BIG_INTEGER_H
+#define BIG_INTEGER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+
+/*                     BIG INTEGER CLASS
+ *
+ *  A minimal arbitrary precision integer, holding exact determinants
+ *  of integer matrices that do not fit in 64 bits. It only supports the
+ *  operations needed by the Chinese Remainder reconstruction of them,
+ *  i.e. multiplying by a word, adding a multiple of another big integer
+ *  and reducing modulo a word, plus printing.
+ */
+
+namespace algebra {
+    class big_integer {
+    protected:    // Class members
+        std::vector<unsigned int> m_limbs;   // Magnitude in base 2^32, least significant limb first
+        bool m_negative;                     // Sign, false for zero
+
+    protected:
+        void trim();
+        static int compareMagnitudes(const std::vector<unsigned int> &, const std::vector<unsigned int> &);
+
+    public: // Constructors
+        big_integer() : m_negative(false) {}
+        big_integer(long long);
+
+    public: // Methods
+        bool isZero() const { return m_limbs.empty(); }
+        int sign() const { return isZero() ? 0 : (m_negative ? -1 : 1); }
+        std::size_t bits() const;
+        unsigned long long modulo(unsigned long long) const;
+        std::string toString() const;
+
+    public: // Operators
+        big_integer operator - () const;
+        big_integer &operator *= (unsigned int);
+        big_integer &operator += (const big_integer &);
+        bool operator == (const big_integer &arg) const { return m_negative == arg.m_negative && m_limbs == arg.m_limbs; }
+        bool operator != (const big_integer &arg) const { return !(*this == arg); }
+    };
+
+    // Operators
+    big_integer operator * (const big_integer &, long long);
+    std::ostream &operator << (std::ostream &, const big_integer &);
+
+
+    // --- BLUEPRINTS ---
+
+    // Converting Constructor
+    inline big_integer::big_integer(long long value) {
+        m_negative = value < 0;
+        unsigned long long magnitude = m_negative ? 0 - (unsigned long long) value : (unsigned long long) value;
+
+        while (magnitude > 0) {
+            m_limbs.push_back((unsigned int) magnitude);
+            magnitude >>= 32;
+        }
+    }
+
+
+    // --- METHODS ---
+
+    // Removes the leading zero limbs, zero is never negative
+    inline void big_integer::trim() {
+        while (!m_limbs.empty() && m_limbs.back() == 0)
+            m_limbs.pop_back();
+        if (m_limbs.empty())
+            m_negative = false;
+    }
+
+    // Returns -1, 0 or 1 as |one| is less than, equal to or greater than |two|
+    inline int big_integer::compareMagnitudes(const std::vector<unsigned int> &one, const std::vector<unsigned int> &two) {
+        if (one.size() != two.size())
+            return one.size() < two.size() ? -1 : 1;
+
+        for (std::size_t i = one.size(); i-- > 0;) {
+            if (one[i] != two[i])
+                return one[i] < two[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    // Returns the number of bits of the magnitude
+    inline std::size_t big_integer::bits() const {
+        if (isZero())
+            return 0;
+
+        std::size_t count = 32 * (m_limbs.size() - 1);
+        for (unsigned int top = m_limbs.back(); top > 0; top >>= 1)
+            ++count;
+        return count;
+    }
+
+    // Returns the residue modulo p (p < 2^32), in [0, p)
+    inline unsigned long long big_integer::modulo(unsigned long long p) const {
+        unsigned long long r = 0;
+
+        for (std::size_t i = m_limbs.size(); i-- > 0;) {
+            r = ((r << 32) | m_limbs[i]) % p;
+        }
+        return (m_negative && r != 0) ? p - r : r;
+    }
+
+    // Returns the decimal representation
+    inline std::string big_integer::toString() const {
+        if (isZero())
+            return "0";
+
+        std::vector<unsigned int> magnitude = m_limbs;
+        std::string digits;
+
+        // Repeated division by 10^9, nine decimal digits at a time
+        while (!magnitude.empty()) {
+            unsigned long long r = 0;
+            for (std::size_t i = magnitude.size(); i-- > 0;) {
+                unsigned long long current = (r << 32) | magnitude[i];
+                magnitude[i] = (unsigned int) (current / 1000000000);
+                r = current % 1000000000;
+            }
+            while (!magnitude.empty() && magnitude.back() == 0)
+                magnitude.pop_back();
+
+            for (int k = 0; k < 9 && (r > 0 || !magnitude.empty()); ++k) {
+                digits.push_back((char) ('0' + r % 10));
+                r /= 10;
+            }
+        }
+        if (m_negative)
+            digits.push_back('-');
+
+        std::reverse(digits.begin(), digits.end());
+        return digits;
+    }
+
+
+    // --- OPERATORS ---
+
+    // Negation operator
+    inline big_integer big_integer::operator - () const {
+        big_integer negation(*this);
+        negation.m_negative = !m_negative && !isZero();
+        return negation;
+    }
+
+    // Times-equals operator with a word
+    inline big_integer &big_integer::operator *= (unsigned int factor) {
+        unsigned long long carry = 0;
+
+        for (unsigned int &limb : m_limbs) {
+            unsigned long long current = (unsigned long long) limb * factor + carry;
+            limb = (unsigned int) current;
+            carry = current >> 32;
+        }
+        if (carry > 0)
+            m_limbs.push_back((unsigned int) carry);
+
+        trim();
+        return *this;
+    }
+
+    // Plus-equals operator
+    inline big_integer &big_integer::operator += (const big_integer &arg) {
+        if (m_negative == arg.m_negative || isZero() || arg.isZero()) {
+            // Same signs: the magnitudes are added
+            bool negative = isZero() ? arg.m_negative : m_negative;
+
+            if (m_limbs.size() < arg.m_limbs.size())
+                m_limbs.resize(arg.m_limbs.size(), 0);
+
+            unsigned long long carry = 0;
+            for (std::size_t i = 0; i < m_limbs.size(); ++i) {
+                carry += (unsigned long long) m_limbs[i] + (i < arg.m_limbs.size() ? arg.m_limbs[i] : 0);
+                m_limbs[i] = (unsigned int) carry;
+                carry >>= 32;
+            }
+            if (carry > 0)
+                m_limbs.push_back((unsigned int) carry);
+            m_negative = negative;
+        } else {
+            // Opposite signs: the smaller magnitude is subtracted from the larger one
+            const std::vector<unsigned int> *larger = &m_limbs;
+            const std::vector<unsigned int> *smaller = &arg.m_limbs;
+            bool negative = m_negative;
+
+            if (compareMagnitudes(m_limbs, arg.m_limbs) < 0) {
+                larger = &arg.m_limbs;
+                smaller = &m_limbs;
+                negative = arg.m_negative;
+            }
+
+            std::vector<unsigned int> difference(larger->size());
+            long long borrow = 0;
+            for (std::size_t i = 0; i < larger->size(); ++i) {
+                long long current = (long long) (*larger)[i] - (i < smaller->size() ? (*smaller)[i] : 0) - borrow;
+                borrow = current < 0 ? 1 : 0;
+                difference[i] = (unsigned int) (current + (borrow << 32));
+            }
+            m_limbs = difference;
+            m_negative = negative;
+        }
+        trim();
+        return *this;
+    }
+
+    // Multiplication operator with a signed word
+    inline big_integer operator * (const big_integer &arg, long long factor) {
+        big_integer prod(arg);
+        unsigned long long magnitude = factor < 0 ? 0 - (unsigned long long) factor : (unsigned long long) factor;
+
+        if (magnitude >> 32) {
+            std::cerr << "Error: big_integer factor must fit in 32 bits" << std::endl;
+            return big_integer(0);
+        }
+        prod *= (unsigned int) magnitude;
+        return factor < 0 ? -prod : prod;
+    }
+
+    // Output stream operator
+    inline std::ostream &operator << (std::ostream &os, const big_integer &arg) {
+        os << arg.toString();
+        return os;
+    }
+}
+
+
+#endif // BIG_INTEGER_H
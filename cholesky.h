@@ -0,0 +1,121 @@
+#ifndef CHOLESKY_H
+#define CHOLESKY_H
+
+#include <cmath>
+
+#include "kernels.h"    // GEMM and TRSM kernels for the blocked engine
+#include "lu.h"         // Scaled determinants
+#include "parallel.h"   // Panels and trailing updates run in parallel
+
+
+/*                  CHOLESKY FACTORIZATION KERNELS
+ *
+ *  A = R^T R factorization of symmetric positive-definite matrices,
+ *  working in place on a row-major buffer with leading dimension lda.
+ *  Only the upper part of the buffer is read and, on exit, it holds the
+ *  upper triangular factor R, the strictly lower part is left untouched.
+ *  No pivoting is needed, and half of the flops of LU are spent.
+ *
+ *  The upper factor, rather than L = R^T, keeps the blocked algorithm
+ *  on contiguous rows: every panel of CHOLESKY_BLOCK_SIZE rows is
+ *  factorized by substitution, the rows right of it are solved by the
+ *  transposed TRSM, and the trailing matrix gets A22 -= R12^T R12 from
+ *  multiplyAddTransposed. The solve and the update are split among the
+ *  threads, by columns and rows respectively.
+ */
+
+namespace algebra {
+    typedef long long dimension_t;  // same data type as in matrix.h
+
+    const dimension_t CHOLESKY_BLOCK_SIZE = 128;  // Rows per panel of the blocked engine
+
+    template <typename T> bool factorCholeskyBlock(T *, dimension_t, dimension_t);
+    template <typename T> bool factorCholesky(T *, dimension_t, dimension_t, unsigned int threads = 0);
+    template <typename T> scaled_determinant choleskyDeterminant(const T *, dimension_t, dimension_t);
+
+
+    // --- BLUEPRINTS ---
+
+    /*  Factorizes the N x N block a in place, unblocked. Returns false if a
+     *  pivot is not positive, i.e. the matrix is not positive definite.
+     */
+    template <typename T>
+    bool factorCholeskyBlock(T *a, dimension_t N, dimension_t lda) {
+        for (dimension_t j = 0; j < N; ++j) {
+            T *row_j = a + j * lda;
+
+            // Also rejects NaN
+            if (!(row_j[j] > (T) 0))
+                return false;
+
+            T pivot = std::sqrt(row_j[j]);
+            row_j[j] = pivot;
+            for (dimension_t c = j + 1; c < N; ++c) {
+                row_j[c] /= pivot;
+            }
+            for (dimension_t i = j + 1; i < N; ++i) {
+                updateRow(N - i, (T) 0 - row_j[i], row_j + i, a + i * lda + i);
+            }
+        }
+        return true;
+    }
+
+    /*  Factorizes the N x N matrix a in place, blocked and multithreaded.
+     *  Returns false if the matrix is not positive definite, a then holds
+     *  a partial factorization.
+     */
+    template <typename T>
+    bool factorCholesky(T *a, dimension_t N, dimension_t lda, unsigned int threads) {
+        for (dimension_t k0 = 0; k0 < N; k0 += CHOLESKY_BLOCK_SIZE) {
+            dimension_t k1 = k0 + CHOLESKY_BLOCK_SIZE < N ? k0 + CHOLESKY_BLOCK_SIZE : N;
+            dimension_t kb = k1 - k0;
+            dimension_t width = N - k1;
+            T *diagonal = a + k0 * lda + k0;
+            T *panel = a + k0 * lda + k1;       // R12, kb x width
+            T *trailing = a + k1 * lda + k1;    // A22, width x width
+
+            if (!factorCholeskyBlock(diagonal, kb, lda))
+                return false;
+            if (width == 0)
+                break;
+
+            // R12 = R11^-T A12, by blocks of columns
+            parallelFor((std::size_t) width, (std::size_t) CHOLESKY_BLOCK_SIZE, [=](std::size_t first, std::size_t last) {
+                solveUpperTransposed(kb, (dimension_t) (last - first), diagonal, lda, panel + first, lda);
+            }, threads);
+
+            // A22 -= R12^T R12, upper part only, by blocks of rows
+            parallelFor((std::size_t) width, (std::size_t) KERNEL_BLOCK_TRSM, [=](std::size_t first, std::size_t last) {
+                for (dimension_t i0 = (dimension_t) first; i0 < (dimension_t) last; i0 += KERNEL_BLOCK_TRSM) {
+                    dimension_t i1 = i0 + KERNEL_BLOCK_TRSM < (dimension_t) last ? i0 + KERNEL_BLOCK_TRSM : (dimension_t) last;
+
+                    // The triangle on the diagonal, row by row
+                    for (dimension_t i = i0; i < i1; ++i) {
+                        for (dimension_t k = 0; k < kb; ++k) {
+                            updateRow(i1 - i, (T) 0 - panel[k * lda + i], panel + k * lda + i, trailing + i * lda + i);
+                        }
+                    }
+                    if (i1 < width) {
+                        multiplyAddTransposed(i1 - i0, width - i1, kb, (T) -1, panel + i0, lda, panel + i1, lda,
+                                              trailing + i0 * lda + i1, lda);
+                    }
+                }
+            }, threads);
+        }
+        return true;
+    }
+
+    // Returns det(A) = (product of the diagonal of R)^2, as mantissa * 2^exponent
+    template <typename T>
+    scaled_determinant choleskyDeterminant(const T *a, dimension_t N, dimension_t lda) {
+        scaled_determinant det = pivotProduct(a, N, lda, 1);
+        int exponent;
+
+        det.mantissa = std::frexp(det.mantissa * det.mantissa, &exponent);
+        det.exponent = det.mantissa == 0 ? 0 : 2 * det.exponent + exponent;
+        return det;
+    }
+}
+
+
+#endif // CHOLESKY_H
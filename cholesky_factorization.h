@@ -0,0 +1,194 @@
+#ifndef CHOLESKY_FACTORIZATION_H
+#define CHOLESKY_FACTORIZATION_H
+
+#include <iostream>
+#include <cmath>
+
+#include "matrix.h"
+#include "parallel.h"   // Right-hand sides solved in parallel
+
+
+/*                CHOLESKY FACTORIZATION CLASS
+ *
+ *  Keeps the A = R^T R factorization of a symmetric positive-definite
+ *  matrix (e.g. a covariance), so that its determinant and the solution
+ *  of linear systems share a single factorization. Only the upper part
+ *  of the matrix is read, its symmetry is assumed.
+ *
+ *  Lazy and not thread-safe until factorized, as lu_factorization. If
+ *  the matrix turns out not to be positive definite, every query reports
+ *  an error and returns NaN (the factors are filled with it) or, for
+ *  solve, a 1 x 1 matrix; use lu_factorization for such matrices.
+ */
+
+namespace algebra {
+    template <class T>
+    class cholesky_factorization
+    {
+    protected:    // Class members
+        mutable sqr_matrix<double> m_factor;    // The matrix, then R in its upper part
+        mutable bool m_positive_definite;
+        mutable bool m_factorized;
+        unsigned int m_threads;
+
+    protected:
+        bool check(const char *) const;
+
+    public: // Constructors
+        cholesky_factorization() = delete;
+        explicit cholesky_factorization(const sqr_matrix<T> &, unsigned int threads = 0);
+
+    public: // Methods
+        void factorize() const;
+        bool isFactorized() const { return m_factorized; }
+        bool isPositiveDefinite() const;
+        dimension_t dimension() const { return m_factor.dimension(); }
+
+        upper_triangular<double> upper() const;
+        lower_triangular<double> lower() const;
+
+        double determinant() const;
+        scaled_determinant scaledDeterminant() const;
+        log_determinant slogdet() const;
+        matrix<double> solve(const matrix<double> &) const;
+    };
+
+
+    // --- BLUEPRINTS ---
+
+    // Explicit Constructor, copies the matrix without factorizing it
+    template <typename T>
+    cholesky_factorization<T>::cholesky_factorization(const sqr_matrix<T> &arg, unsigned int threads)
+            : m_factor(arg.dimension()), m_positive_definite(false), m_factorized(false), m_threads(threads) {
+        for (dimension_t i = 0; i < arg.dimension(); ++i) {
+            for (dimension_t j = i; j < arg.dimension(); ++j) {
+                m_factor[i][j] = (double) arg[i][j];
+            }
+        }
+    }
+
+
+    // --- METHODS ---
+
+    // Factorizes the matrix, if not already done
+    template <typename T>
+    void cholesky_factorization<T>::factorize() const {
+        if (!m_factorized) {
+            m_positive_definite = factorCholesky(m_factor[0], dimension(), dimension(), m_threads);
+            m_factorized = true;
+        }
+    }
+
+    // Returns whether the matrix is positive definite, i.e. whether the factorization succeeded
+    template <typename T>
+    bool cholesky_factorization<T>::isPositiveDefinite() const {
+        factorize();
+        return m_positive_definite;
+    }
+
+    // Reports the failed operation if the matrix is not positive definite
+    template <typename T>
+    bool cholesky_factorization<T>::check(const char *operation) const {
+        if (!isPositiveDefinite()) {
+            std::cerr << "Error: cannot " << operation << ", the matrix is not positive definite" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Returns the upper triangular factor R, filled with NaN if the matrix is not positive definite
+    template <typename T>
+    upper_triangular<double> cholesky_factorization<T>::upper() const {
+        upper_triangular<double> R(dimension());
+
+        if (!check("return the factor")) {
+            R.init(NAN);
+            return R;
+        }
+        for (dimension_t i = 0; i < dimension(); ++i) {
+            for (dimension_t j = i; j < dimension(); ++j) {
+                R[i][j] = m_factor[i][j];
+            }
+        }
+        return R;
+    }
+
+    // Returns the lower triangular factor L = R^T, A = L L^T, filled with NaN if the matrix is not positive definite
+    template <typename T>
+    lower_triangular<double> cholesky_factorization<T>::lower() const {
+        lower_triangular<double> L(dimension());
+
+        if (!check("return the factor")) {
+            L.init(NAN);
+            return L;
+        }
+        for (dimension_t i = 0; i < dimension(); ++i) {
+            for (dimension_t j = 0; j <= i; ++j) {
+                L[i][j] = m_factor[j][i];
+            }
+        }
+        return L;
+    }
+
+    // Returns the determinant of the matrix, NaN if it is not positive definite
+    template <typename T>
+    double cholesky_factorization<T>::determinant() const {
+        scaled_determinant det = scaledDeterminant();
+        return std::ldexp(det.mantissa, (int) det.exponent);
+    }
+
+    // Returns the determinant as mantissa * 2^exponent
+    template <typename T>
+    scaled_determinant cholesky_factorization<T>::scaledDeterminant() const {
+        if (!check("compute the determinant")) {
+            return {NAN, 0};
+        }
+        return choleskyDeterminant(m_factor[0], dimension(), dimension());
+    }
+
+    /*  Returns the sign (always 1) and the natural logarithm of the
+     *  determinant, summed directly from the diagonal of R.
+     */
+    template <typename T>
+    log_determinant cholesky_factorization<T>::slogdet() const {
+        if (!check("compute the determinant")) {
+            return {0, NAN};
+        }
+        double logarithm = 0;
+
+        for (dimension_t i = 0; i < dimension(); ++i) {
+            logarithm += std::log(m_factor[i][i]);
+        }
+        return {1, 2 * logarithm};
+    }
+
+    // Returns X, the solution of A X = B, for every column of B
+    template <typename T>
+    matrix<double> cholesky_factorization<T>::solve(const matrix<double> &B) const {
+        if (B.numOfRows() != dimension()) {
+            std::cerr << "Error: cannot solve the linear system\n"
+                      << "Rows of the right-hand side do not match the matrix"
+                      << std::endl;
+            return matrix<double>(1, 1);
+        }
+        if (!check("solve the linear system")) {
+            return matrix<double>(1, 1);
+        }
+        matrix<double> X(B);
+        dimension_t N = dimension();
+        dimension_t columns = X.numOfCols();
+        double *x = X[0];
+        const double *r = m_factor[0];
+
+        // R^T Y = B, then R X = Y
+        parallelFor((std::size_t) columns, (std::size_t) CHOLESKY_BLOCK_SIZE, [=](std::size_t first, std::size_t last) {
+            solveUpperTransposed(N, (dimension_t) (last - first), r, N, x + first, columns);
+            solveUpper(N, (dimension_t) (last - first), r, N, x + first, columns);
+        }, m_threads);
+
+        return X;
+    }
+}
+
+
+#endif // CHOLESKY_FACTORIZATION_H
@@ -0,0 +1,258 @@
+#ifndef COMPANION_H
+#define COMPANION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include "matrix.h"
+#include "modular.h"    // Arithmetic modulo word-size primes
+
+
+/*                   COMPANION MATRIX CLASS
+ *
+ *  The matrix of a k-term linear recurrence
+ *      a(m + k) = c1 a(m + k - 1) + c2 a(m + k - 2) + ... + ck a(m),
+ *  with the coefficients c1 ... ck in its first row and ones below the
+ *  diagonal, so that it maps the state (a(m + k - 1), ..., a(m)) to the
+ *  next one. Its powers are cheap, because of the Cayley-Hamilton
+ *  theorem: C^n = r(C), where r(x) = x^n mod chi(x) and
+ *      chi(x) = x^k - c1 x^(k-1) - ... - ck
+ *  is the characteristic polynomial. r has k coefficients, which also
+ *  give every term of the recurrence, a(m + n) = sum r_i a(m + i), and it
+ *  is computed by binary exponentiation of polynomials modulo chi, in
+ *  O(k^2 log n) instead of the O(k^3 log n) of matrix multiplications.
+ *  Row p of C^n holds the coefficients of x^(n + k - 1 - p) mod chi,
+ *  reversed, so the whole power follows in another O(k^2).
+ *
+ *  pow() and powMod() hide the ones of sqr_matrix, so they dispatch to
+ *  the polynomial algorithm through the type. The structure is assumed,
+ *  not checked: the coefficients are read from the first row, and the
+ *  rest of the matrix must not be changed.
+ */
+
+namespace algebra {
+    template <class T>
+    class companion_matrix : public sqr_matrix<T>
+    {
+    protected:
+        std::vector<T> coefficients() const;
+
+    public: // Constructors
+        companion_matrix() = delete;
+        explicit companion_matrix(const std::vector<T> &);
+
+    public: // Methods
+        sqr_matrix<T> pow(long long) const;
+        sqr_matrix<T> powMod(unsigned long long, residue_t) const;
+        T term(long long, const std::vector<T> &) const;
+        T termMod(unsigned long long, const std::vector<T> &, residue_t) const;
+    };
+
+    template <typename S, typename F> std::vector<S> powerModuloCharacteristic(unsigned long long, const std::vector<S> &, F);
+    template <typename S, typename F> void multiplyByX(std::vector<S> &, const std::vector<S> &, F);
+
+
+    // --- BLUEPRINTS ---
+
+    // Explicit Constructor, from the coefficients c1 ... ck of the recurrence
+    template <typename T>
+    companion_matrix<T>::companion_matrix(const std::vector<T> &coefficients)
+            : sqr_matrix<T>(coefficients.empty() ? 1 : (dimension_t) coefficients.size()) {
+        if (coefficients.empty()) {
+            std::cerr << "Error: a companion matrix needs at least one coefficient" << std::endl;
+        }
+        this->init((T) 0);
+        for (std::size_t j = 0; j < coefficients.size(); ++j) {
+            (*this)[0][j] = coefficients[j];
+        }
+        for (dimension_t i = 1; i < this->dimension(); ++i) {
+            (*this)[i][i - 1] = (T) 1;
+        }
+    }
+
+    /*  Returns the coefficients of x^n mod chi(x), lowest degree first, where
+     *  chi is given by the coefficients c1 ... ck of the recurrence, by
+     *  left-to-right binary exponentiation. accumulate(s, a, b) returns
+     *  s + a * b in the arithmetic of the scalars.
+     */
+    template <typename S, typename F>
+    std::vector<S> powerModuloCharacteristic(unsigned long long n, const std::vector<S> &c, F accumulate) {
+        std::size_t k = c.size();
+        std::vector<S> power(k, (S) 0);
+        std::vector<S> square(2 * k - 1);
+
+        power[0] = (S) 1;
+        if (n == 0)
+            return power;
+
+        int bit = 63;
+        while (!((n >> bit) & 1))
+            --bit;
+
+        for (; bit >= 0; --bit) {
+            // power = power^2 mod chi, the terms of degree d >= k folded by x^d = sum cj x^(d - j)
+            std::fill(square.begin(), square.end(), (S) 0);
+            for (std::size_t i = 0; i < k; ++i) {
+                for (std::size_t j = 0; j < k; ++j) {
+                    square[i + j] = accumulate(square[i + j], power[i], power[j]);
+                }
+            }
+            for (std::size_t d = 2 * k - 2; d >= k; --d) {
+                for (std::size_t j = 1; j <= k; ++j) {
+                    square[d - j] = accumulate(square[d - j], square[d], c[j - 1]);
+                }
+            }
+            std::copy(square.begin(), square.begin() + (std::ptrdiff_t) k, power.begin());
+
+            if ((n >> bit) & 1)
+                multiplyByX(power, c, accumulate);
+        }
+        return power;
+    }
+
+    // r = x * r mod chi, in O(k)
+    template <typename S, typename F>
+    void multiplyByX(std::vector<S> &r, const std::vector<S> &c, F accumulate) {
+        std::size_t k = c.size();
+        S top = r[k - 1];
+
+        for (std::size_t i = k - 1; i > 0; --i) {
+            r[i] = accumulate(r[i - 1], top, c[k - 1 - i]);
+        }
+        r[0] = accumulate((S) 0, top, c[k - 1]);
+    }
+
+
+    // --- METHODS ---
+
+    // Returns the coefficients c1 ... ck, from the first row
+    template <typename T>
+    std::vector<T> companion_matrix<T>::coefficients() const {
+        return std::vector<T>((*this)[0], (*this)[0] + this->dimension());
+    }
+
+    /*  Returns the matrix to the power of the argument, in O(k^2 log(exp)),
+     *  the rows of the power being x^(exp + k - 1) ... x^exp mod chi.
+     */
+    template <typename T>
+    sqr_matrix<T> companion_matrix<T>::pow(long long exp) const {
+        if (exp <= 0) {
+            std::cerr << "Error: Exponent of matrix must be greater than zero!" << std::endl;
+            return (*this);
+        }
+        dimension_t k = this->dimension();
+        std::vector<T> c = coefficients();
+        auto accumulate = [](T s, T a, T b) { return s + a * b; };
+
+        std::vector<T> r = powerModuloCharacteristic((unsigned long long) exp, c, accumulate);
+        sqr_matrix<T> power(k);
+
+        for (dimension_t p = k - 1; p >= 0; --p) {
+            for (dimension_t q = 0; q < k; ++q) {
+                power[p][q] = r[k - 1 - q];
+            }
+            multiplyByX(r, c, accumulate);
+        }
+        return power;
+    }
+
+    /*  Returns the matrix to the power of the argument modulo the prime
+     *  1 < p < 2^32, as sqr_matrix::powMod, in O(k^2 log(exp)).
+     */
+    template <typename T>
+    sqr_matrix<T> companion_matrix<T>::powMod(unsigned long long exp, residue_t p) const {
+        static_assert(std::is_integral<T>::value, "powMod requires a matrix of integers");
+
+        if (p < 2 || p > 0xFFFFFFFFULL) {
+            std::cerr << "Error: modulus of matrix power must be in [2, 2^32)" << std::endl;
+            return sqr_matrix<T>(1);
+        }
+        dimension_t k = this->dimension();
+        std::vector<residue_t> c((std::size_t) k);
+        auto accumulate = [p](residue_t s, residue_t a, residue_t b) { return (s + mulMod(a, b, p)) % p; };
+
+        for (dimension_t j = 0; j < k; ++j) {
+            if constexpr (std::is_signed<T>::value) {
+                c[j] = reduceMod((long long) (*this)[0][j], p);
+            } else {
+                c[j] = (residue_t) (*this)[0][j] % p;
+            }
+        }
+
+        std::vector<residue_t> r = powerModuloCharacteristic(exp, c, accumulate);
+        sqr_matrix<T> power(k);
+
+        for (dimension_t row = k - 1; row >= 0; --row) {
+            for (dimension_t q = 0; q < k; ++q) {
+                power[row][q] = (T) r[k - 1 - q];
+            }
+            multiplyByX(r, c, accumulate);
+        }
+        return power;
+    }
+
+    /*  Returns the term a(n) of the recurrence, given its first k terms
+     *  a(0) ... a(k - 1), in O(k^2 log(n)).
+     */
+    template <typename T>
+    T companion_matrix<T>::term(long long n, const std::vector<T> &initial) const {
+        dimension_t k = this->dimension();
+
+        if ((dimension_t) initial.size() != k || n < 0) {
+            std::cerr << "Error: a recurrence of order " << k << " needs " << k
+                      << " initial terms and a non-negative index" << std::endl;
+            return (T) 0;
+        }
+        if (n < k)
+            return initial[n];
+
+        auto accumulate = [](T s, T a, T b) { return s + a * b; };
+        std::vector<T> r = powerModuloCharacteristic((unsigned long long) n, coefficients(), accumulate);
+        T value = (T) 0;
+
+        for (dimension_t i = 0; i < k; ++i) {
+            value = accumulate(value, r[i], initial[i]);
+        }
+        return value;
+    }
+
+    // Returns the term a(n) of the recurrence modulo the prime 1 < p < 2^32, in [0, p)
+    template <typename T>
+    T companion_matrix<T>::termMod(unsigned long long n, const std::vector<T> &initial, residue_t p) const {
+        static_assert(std::is_integral<T>::value, "termMod requires a recurrence of integers");
+        dimension_t k = this->dimension();
+
+        if ((dimension_t) initial.size() != k || p < 2 || p > 0xFFFFFFFFULL) {
+            std::cerr << "Error: a recurrence of order " << k << " needs " << k
+                      << " initial terms and a modulus in [2, 2^32)" << std::endl;
+            return (T) 0;
+        }
+        auto residue = [p](T scalar) {
+            if constexpr (std::is_signed<T>::value) {
+                return reduceMod((long long) scalar, p);
+            } else {
+                return (residue_t) scalar % p;
+            }
+        };
+        auto accumulate = [p](residue_t s, residue_t a, residue_t b) { return (s + mulMod(a, b, p)) % p; };
+
+        std::vector<residue_t> c((std::size_t) k);
+        for (dimension_t j = 0; j < k; ++j) {
+            c[j] = residue((*this)[0][j]);
+        }
+
+        std::vector<residue_t> r = powerModuloCharacteristic(n, c, accumulate);
+        residue_t value = 0;
+
+        for (dimension_t i = 0; i < k; ++i) {
+            value = accumulate(value, r[i], residue(initial[i]));
+        }
+        return (T) value;
+    }
+}
+
+
+#endif // COMPANION_H
@@ -2,6 +2,7 @@
 #define COMPLEX_H
 
 #include <iostream>
+#include <cmath>
 
 /*                     COMPLEX NUMBERS
  *
@@ -30,6 +31,7 @@ namespace algebra
 
         double real() const { return a; }
         double imaginary() const { return b; }
+        double magnitude() const { return std::hypot(a, b); }
 
     public:	// Operators
         complex& operator += (const complex&);
@@ -45,6 +47,7 @@ namespace algebra
     complex operator / (const complex&, const complex&);
     std::istream& operator >> (std::istream&, complex&);
     std::ostream& operator << (std::ostream&, const complex&);
+    double magnitude(const complex&);
 
 
     // --- BLUEPRINTS ---
@@ -86,9 +89,10 @@ namespace algebra
     complex& complex::operator *= (const complex& arg) {
         double c = arg.a;
         double d = arg.b;
+        double a_prev = this->real();
 
         a = a * c - b * d;
-        b = a * d + b * c;
+        b = a_prev * d + b * c;
 
         return *this;
     }
@@ -157,6 +161,11 @@ namespace algebra
         return div;
     }
 
+    // Modulus, the pivot size of the factorizations (head to kernels.h)
+    double magnitude(const complex& arg) {
+        return arg.magnitude();
+    }
+
     // Input stream operator
     std::istream& operator >> (std::istream& is, complex& arg) {
         double a;
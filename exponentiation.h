@@ -0,0 +1,243 @@
+#ifndef EXPONENTIATION_H
+#define EXPONENTIATION_H
+
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+
+/*                      ADDITION CHAINS
+ *
+ *  An addition chain for an exponent e is a sequence 1 = c0 < c1 < ... = e
+ *  where every term is the sum of two earlier ones (possibly the same one
+ *  twice), so x^e follows from x by one multiplication per term. The
+ *  length of the chain is the number of multiplications, which is what
+ *  the exponentiation of expensive objects, such as matrices, minimizes.
+ *
+ *  Binary exponentiation needs up to 2 log2(e) multiplications. For large
+ *  exponents, the sliding window method needs about
+ *      log2(e) + log2(e) / (w + 1) + 2^(w-1)
+ *  of them: the exponent is cut into windows of at most w bits, starting
+ *  and ending with a set bit, and each window costs a single
+ *  multiplication by one of the precomputed odd powers x^1, x^3, ...,
+ *  x^(2^w - 1). It is the k-ary method with the even digits pruned, so
+ *  it never does worse, but its table keeps up to 2^(w-1) odd powers
+ *  alive besides the running product.
+ *
+ *  Exponents up to EXPONENT_CHAIN_LIMIT also get an optimal chain,
+ *  found by iterative deepening over star chains (every term adds the
+ *  previous one), which are optimal for all exponents below 12509.
+ *
+ *  Shorter chains trade memory for multiplications, so additionChain()
+ *  takes a budget of working buffers (terms alive at the same time,
+ *  besides the base) and returns the shortest chain within it. The
+ *  default, EXPONENT_DEFAULT_BUFFERS = 3, allows windows of 2 bits (about
+ *  10% fewer multiplications than the binary chain on 64-bit exponents)
+ *  and the optimal chain of half the exponents up to 256, for four N x N
+ *  matrices at peak, the base included. A budget of 2, the least any
+ *  chain needs, gives the binary chain in three matrices for callers
+ *  tight on memory; 5 allows windows of 3 bits (14%) and 9 of 4 bits,
+ *  at one N x N matrix per buffer.
+ *
+ *  Chains are described by their steps, term k + 1 being the sum of
+ *  terms "one" and "two"; liveness() tells when each term is used for the
+ *  last time, so that assignBuffers() can recycle its storage.
+ */
+
+namespace algebra {
+    const unsigned long long EXPONENT_CHAIN_LIMIT = 256;   // Largest exponent given an optimal chain
+    const int EXPONENT_MAX_WINDOW = 4;            // Widest window of the sliding window method
+    const int EXPONENT_DEFAULT_BUFFERS = 3;       // Default budget of working buffers, 2 being the least any chain needs
+
+    // Term k + 1 of a chain, the sum of terms one and two
+    struct chain_step {
+        int one;
+        int two;
+    };
+
+    std::vector<chain_step> additionChain(unsigned long long, int buffers = EXPONENT_DEFAULT_BUFFERS);
+    std::vector<chain_step> slidingWindowChain(unsigned long long, int);
+    std::vector<chain_step> optimalChain(unsigned long long);
+    std::vector<int> liveness(const std::vector<chain_step> &);
+    std::vector<int> assignBuffers(const std::vector<chain_step> &, int *);
+
+
+    // --- BLUEPRINTS ---
+
+    // Returns the number of working buffers the chain needs
+    inline int bufferCount(const std::vector<chain_step> &chain) {
+        int count;
+        assignBuffers(chain, &count);
+        return count;
+    }
+
+    // Extends the star chain of terms to reach exp in at most limit terms, returns whether it did
+    inline bool searchStarChain(std::vector<unsigned long long> &terms, unsigned long long exp, std::size_t limit) {
+        unsigned long long last = terms.back();
+
+        if (last == exp)
+            return true;
+        if (terms.size() == limit)
+            return false;
+
+        for (std::size_t j = terms.size(); j-- > 0;) {
+            unsigned long long next = last + terms[j];
+            if (next > exp)
+                continue;
+            // Doubling at every remaining step is the fastest possible growth
+            if ((next << (limit - terms.size() - 1)) < exp)
+                break;
+
+            terms.push_back(next);
+            if (searchStarChain(terms, exp, limit))
+                return true;
+            terms.pop_back();
+        }
+        return false;
+    }
+
+
+    // --- METHODS ---
+
+    /*  Returns the shortest chain for the exponent (> 0) needing at most the
+     *  given number of working buffers, among the optimal chain of small
+     *  exponents and the sliding window ones; the binary chain, which needs
+     *  two, is always a candidate.
+     */
+    inline std::vector<chain_step> additionChain(unsigned long long exp, int buffers) {
+        std::vector<chain_step> best = slidingWindowChain(exp, 1);
+
+        for (int width = 2; width <= EXPONENT_MAX_WINDOW; ++width) {
+            std::vector<chain_step> chain = slidingWindowChain(exp, width);
+            if (chain.size() < best.size() && bufferCount(chain) <= buffers)
+                best = chain;
+        }
+        if (exp <= EXPONENT_CHAIN_LIMIT) {
+            std::vector<chain_step> chain = optimalChain(exp);
+            if (chain.size() < best.size() && bufferCount(chain) <= buffers)
+                best = chain;
+        }
+        return best;
+    }
+
+    // Returns the sliding window chain of the exponent (> 0), with windows up to width bits
+    inline std::vector<chain_step> slidingWindowChain(unsigned long long exp, int width) {
+        // The windows, from the highest bit, as (odd digit, bits after the previous window)
+        std::vector<std::pair<unsigned long long, int>> windows;
+        int bit = 63;
+        int shift = 0;
+        unsigned long long largest = 1;
+
+        while (!((exp >> bit) & 1))
+            --bit;
+        while (bit >= 0) {
+            if (!((exp >> bit) & 1)) {
+                ++shift;
+                --bit;
+                continue;
+            }
+            int low = bit - width + 1 < 0 ? 0 : bit - width + 1;
+            while (!((exp >> low) & 1))
+                ++low;
+
+            unsigned long long digit = (exp >> low) & ((1ULL << (bit - low)) * 2 - 1);
+            windows.emplace_back(digit, shift + bit - low + 1);
+            if (digit > largest)
+                largest = digit;
+            shift = 0;
+            bit = low - 1;
+        }
+
+        // Table of the odd powers, term of digit d at position index[d / 2]
+        std::vector<chain_step> chain;
+        std::vector<int> index(1, 0);
+
+        if (largest > 1) {
+            chain.push_back({0, 0});
+            int square = (int) chain.size();
+            for (unsigned long long digit = 3; digit <= largest; digit += 2) {
+                chain.push_back({index.back(), square});
+                index.push_back((int) chain.size());
+            }
+        }
+
+        int current = index[windows[0].first / 2];
+        for (std::size_t w = 1; w < windows.size(); ++w) {
+            for (int s = 0; s < windows[w].second; ++s) {
+                chain.push_back({current, current});
+                current = (int) chain.size();
+            }
+            chain.push_back({current, index[windows[w].first / 2]});
+            current = (int) chain.size();
+        }
+        for (int s = 0; s < shift; ++s) {
+            chain.push_back({current, current});
+            current = (int) chain.size();
+        }
+        return chain;
+    }
+
+    // Returns a shortest chain of the exponent (> 0), exponential in its length, keep it small
+    inline std::vector<chain_step> optimalChain(unsigned long long exp) {
+        std::vector<unsigned long long> terms(1, 1);
+        std::size_t limit = 1;
+
+        while ((1ULL << (limit - 1)) < exp)
+            ++limit;
+        while (!searchStarChain(terms, exp, limit))
+            ++limit;
+
+        std::vector<chain_step> chain;
+        for (std::size_t k = 1; k < terms.size(); ++k) {
+            unsigned long long addend = terms[k] - terms[k - 1];
+            int j = 0;
+            while (terms[j] != addend)
+                ++j;
+            chain.push_back({(int) k - 1, j});
+        }
+        return chain;
+    }
+
+    // Returns, for every term of the chain, the last step using it (-1 if none)
+    inline std::vector<int> liveness(const std::vector<chain_step> &chain) {
+        std::vector<int> last(chain.size() + 1, -1);
+
+        for (std::size_t k = 0; k < chain.size(); ++k) {
+            last[chain[k].one] = (int) k;
+            last[chain[k].two] = (int) k;
+        }
+        return last;
+    }
+
+    /*  Returns, for every term of the chain, the buffer holding it, and the
+     *  number of buffers in count. A buffer is reused once the term it
+     *  holds is read for the last time, never by the step reading it, so
+     *  products are not written over their factors. Term 0, the base, is
+     *  not given one (-1), it is read from wherever the caller keeps it.
+     */
+    inline std::vector<int> assignBuffers(const std::vector<chain_step> &chain, int *count) {
+        std::vector<int> last = liveness(chain);
+        std::vector<int> buffer(chain.size() + 1, -1);
+        std::vector<int> available;
+
+        *count = 0;
+        for (std::size_t k = 0; k < chain.size(); ++k) {
+            if (available.empty()) {
+                buffer[k + 1] = (*count)++;
+            } else {
+                buffer[k + 1] = available.back();
+                available.pop_back();
+            }
+            for (int operand : {chain[k].one, chain[k].two}) {
+                if (operand != 0 && last[operand] == (int) k) {
+                    available.push_back(buffer[operand]);
+                    last[operand] = -1;
+                }
+            }
+        }
+        return buffer;
+    }
+}
+
+
+#endif // EXPONENTIATION_H
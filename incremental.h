@@ -0,0 +1,203 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <cmath>
+#include <vector>
+
+#include "matrix.h"
+
+
+/*                INCREMENTAL DETERMINANT CLASS
+ *
+ *  Keeps the determinant and the inverse of a square matrix while its
+ *  rows or columns are replaced one at a time, as in Monte Carlo moves.
+ *  Replacing row r of A by u is the rank-1 change A + e_r (u - a_r)^T,
+ *  whose determinant ratio is given by the matrix determinant lemma,
+ *      det(A') / det(A) = u^T A^-1 e_r,
+ *  and whose inverse follows from the Sherman-Morrison formula, in O(n^2)
+ *  instead of the O(n^3) of a fresh factorization. Columns are the same,
+ *  transposed. The ratio of a proposed replacement is available on its
+ *  own, in O(n), so that a rejected move costs next to nothing.
+ *
+ *  Every update adds rounding errors to the inverse, so the matrix itself
+ *  is kept as well and the inverse and determinant are recomputed from it
+ *  by LU after every "interval" updates.
+ */
+
+namespace algebra {
+    const long long REFACTORIZATION_INTERVAL = 100;   // Default updates between two refactorizations
+
+    template <class T>
+    class incremental_determinant
+    {
+    protected:    // Class members
+        sqr_matrix<double> m_matrix;
+        sqr_matrix<double> m_inverse;
+        scaled_determinant m_determinant;
+        long long m_updates;            // Updates since the last refactorization
+        long long m_interval;
+
+    protected:
+        bool update(double);
+
+    public: // Constructors
+        incremental_determinant() = delete;
+        explicit incremental_determinant(const sqr_matrix<T> &, long long interval = REFACTORIZATION_INTERVAL);
+
+    public: // Methods
+        dimension_t dimension() const { return m_matrix.dimension(); }
+        const sqr_matrix<double> &currentMatrix() const { return m_matrix; }
+        const sqr_matrix<double> &inverse() const { return m_inverse; }
+        bool isSingular() const { return m_determinant.mantissa == 0; }
+
+        double determinant() const { return std::ldexp(m_determinant.mantissa, (int) m_determinant.exponent); }
+        scaled_determinant scaledDeterminant() const { return m_determinant; }
+        log_determinant slogdet() const { return logarithmOf(m_determinant); }
+
+        double rowRatio(dimension_t, const std::vector<T> &) const;
+        double columnRatio(dimension_t, const std::vector<T> &) const;
+        void replaceRow(dimension_t, const std::vector<T> &);
+        void replaceColumn(dimension_t, const std::vector<T> &);
+        void refactorize();
+    };
+
+
+    // --- BLUEPRINTS ---
+
+    // Explicit Constructor, factorizes the matrix
+    template <typename T>
+    incremental_determinant<T>::incremental_determinant(const sqr_matrix<T> &arg, long long interval)
+            : m_matrix(arg.dimension()), m_inverse(arg.dimension()), m_determinant{0, 0}, m_updates(0),
+              m_interval(interval) {
+        for (dimension_t i = 0; i < dimension(); ++i) {
+            for (dimension_t j = 0; j < dimension(); ++j) {
+                m_matrix[i][j] = (double) arg[i][j];
+            }
+        }
+        refactorize();
+    }
+
+
+    // --- METHODS ---
+
+    /*  Recomputes the inverse and the determinant from the matrix, by LU.
+     *  The inverse of a singular matrix is left undefined, so replacements
+     *  refactorize until one makes the matrix regular again.
+     */
+    template <typename T>
+    void incremental_determinant<T>::refactorize() {
+        dimension_t N = dimension();
+        std::vector<dimension_t> perm((std::size_t) N);
+
+        m_inverse = m_matrix;
+        int sign = factorSquareLU(m_inverse[0], N, N, perm.data());
+        m_determinant = pivotProduct(m_inverse[0], N, N, sign);
+        m_updates = 0;
+
+        if (!isSingular()) {
+            invertFactorizedLU(m_inverse[0], N, N, perm.data());
+        }
+    }
+
+    // Returns det(A') / det(A), A' being the matrix with row r replaced by u
+    template <typename T>
+    double incremental_determinant<T>::rowRatio(dimension_t r, const std::vector<T> &u) const {
+        double ratio = 0;
+
+        for (dimension_t k = 0; k < dimension(); ++k) {
+            ratio += (double) u[k] * m_inverse[k][r];
+        }
+        return ratio;
+    }
+
+    // Returns det(A') / det(A), A' being the matrix with column c replaced by v
+    template <typename T>
+    double incremental_determinant<T>::columnRatio(dimension_t c, const std::vector<T> &v) const {
+        double ratio = 0;
+
+        for (dimension_t k = 0; k < dimension(); ++k) {
+            ratio += m_inverse[c][k] * (double) v[k];
+        }
+        return ratio;
+    }
+
+    /*  Scales the determinant by the ratio, returns whether the inverse can
+     *  be updated, i.e. the matrix was and stays regular and no
+     *  refactorization is due.
+     */
+    template <typename T>
+    bool incremental_determinant<T>::update(double ratio) {
+        if (isSingular())
+            return false;
+
+        int exponent;
+
+        m_determinant.mantissa = std::frexp(m_determinant.mantissa * ratio, &exponent);
+        m_determinant.exponent = m_determinant.mantissa == 0 ? 0 : m_determinant.exponent + exponent;
+        return ++m_updates < m_interval && ratio != 0;
+    }
+
+    /*  Replaces row r of the matrix by u, in O(n^2):
+     *      A'^-1 = A^-1 - A^-1 e_r (u^T A^-1 - e_r^T) / ratio
+     */
+    template <typename T>
+    void incremental_determinant<T>::replaceRow(dimension_t r, const std::vector<T> &u) {
+        dimension_t N = dimension();
+        double ratio = rowRatio(r, u);
+
+        for (dimension_t j = 0; j < N; ++j) {
+            m_matrix[r][j] = (double) u[j];
+        }
+        if (!update(ratio)) {
+            refactorize();
+            return;
+        }
+
+        std::vector<double> column((std::size_t) N);
+        std::vector<double> product((std::size_t) N, 0.0);
+
+        for (dimension_t k = 0; k < N; ++k) {
+            column[k] = m_inverse[k][r];
+            updateRow(N, (double) u[k], m_inverse[k], product.data());
+        }
+        product[r] -= 1;
+
+        for (dimension_t i = 0; i < N; ++i) {
+            updateRow(N, -column[i] / ratio, product.data(), m_inverse[i]);
+        }
+    }
+
+    /*  Replaces column c of the matrix by v, in O(n^2):
+     *      A'^-1 = A^-1 - (A^-1 v - e_c) e_c^T A^-1 / ratio
+     */
+    template <typename T>
+    void incremental_determinant<T>::replaceColumn(dimension_t c, const std::vector<T> &v) {
+        dimension_t N = dimension();
+        double ratio = columnRatio(c, v);
+
+        for (dimension_t i = 0; i < N; ++i) {
+            m_matrix[i][c] = (double) v[i];
+        }
+        if (!update(ratio)) {
+            refactorize();
+            return;
+        }
+
+        std::vector<double> product((std::size_t) N, 0.0);
+        std::vector<double> row(m_inverse[c], m_inverse[c] + N);
+
+        for (dimension_t i = 0; i < N; ++i) {
+            for (dimension_t k = 0; k < N; ++k) {
+                product[i] += m_inverse[i][k] * (double) v[k];
+            }
+        }
+        product[c] -= 1;
+
+        for (dimension_t i = 0; i < N; ++i) {
+            updateRow(N, -product[i] / ratio, row.data(), m_inverse[i]);
+        }
+    }
+}
+
+
+#endif // INCREMENTAL_H
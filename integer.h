@@ -0,0 +1,297 @@
+#ifndef INTEGER_H
+#define INTEGER_H
+
+#include <iostream>
+#include <cmath>
+#include <climits>
+#include <type_traits>
+
+#include "matrix.h"
+#include "modular.h"        // Arithmetic over GF(p)
+#include "big_integer.h"    // Determinants beyond 64 bits
+#include "parallel.h"       // One thread per prime
+
+
+/*                  EXACT INTEGER DETERMINANTS
+ *
+ *  sqr_matrix<T>::determinant() works in floating point arithmetic, so
+ *  for integer matrices it returns a rounded value. The functions below
+ *  compute the exact determinant of matrices with integral scalars.
+ *
+ *  bareissDeterminant uses Bareiss' fraction-free elimination: step k
+ *  replaces every trailing scalar with the 2x2 minor
+ *
+ *      a[i][j] = (a[i][j] * a[k][k] - a[i][k] * a[k][j]) / a[k-1][k-1]
+ *
+ *  where the division is always exact, and every intermediate scalar is
+ *  a minor of the original matrix. Hence all of them are bounded by the
+ *  Hadamard bound of the matrix: when it is below 2^31 the elimination
+ *  runs entirely in 64-bit arithmetic, otherwise the products are formed
+ *  in 128-bit intermediates (a GCC / Clang extension) and each quotient
+ *  is checked to still fit in 64 bits. A determinant beyond 64 bits is
+ *  reported through the return value, so it is never mistaken for 0.
+ *
+ *  modularDeterminant handles determinants of any size: it computes the
+ *  determinant modulo many word-size primes, each one by an independent
+ *  elimination over GF(p) on its own thread, and reconstructs the exact
+ *  value with the Chinese Remainder Theorem. Enough primes are used for
+ *  their product to exceed twice the Hadamard bound, unless the value
+ *  stays unchanged for CRT_EARLY_TERMINATION consecutive primes first,
+ *  which happens with probability about 2^-31 per prime for a wrong value.
+ */
+
+namespace algebra {
+    const residue_t CRT_FIRST_PRIME = 2147483647;  // 2^31 - 1, the largest prime used
+    const int CRT_EARLY_TERMINATION = 2;          // Consecutive primes that leave the value unchanged
+
+    template <typename T> bool bareissDeterminant(const sqr_matrix<T> &, long long &);
+    template <typename T> big_integer modularDeterminant(const sqr_matrix<T> &, unsigned int threads = 0);
+    template <typename T> residue_t determinantMod(const sqr_matrix<T> &, residue_t);
+    template <typename T> double hadamardBound(const sqr_matrix<T> &);
+
+
+    // --- BLUEPRINTS ---
+
+    // Returns log2 of the Hadamard bound, the product of the euclidean norms of the rows
+    template <typename T>
+    double hadamardBound(const sqr_matrix<T> &arg) {
+        double bound = 0;
+
+        for (dimension_t i = 0; i < arg.dimension(); ++i) {
+            double norm = 0;
+            for (dimension_t j = 0; j < arg.dimension(); ++j) {
+                norm += (double) arg[i][j] * (double) arg[i][j];
+            }
+            if (norm == 0)
+                return -INFINITY;
+            bound += 0.5 * std::log2(norm);
+        }
+        return bound;
+    }
+
+    /*  Fraction-free elimination of the N x N matrix a in place, with products
+     *  formed in the type W. Returns false if a quotient does not fit in 64 bits.
+     */
+    template <typename W>
+    bool eliminateBareiss(long long *a, dimension_t N, int &sign) {
+        long long previous = 1;
+
+        for (dimension_t k = 0; k < N - 1; ++k) {
+            long long *pivot_row = a + k * N;
+
+            if (pivot_row[k] == 0) {
+                dimension_t p = k + 1;
+                while (p < N && a[p * N + k] == 0)
+                    ++p;
+                if (p == N) {
+                    sign = 0;
+                    return true;
+                }
+                for (dimension_t j = k; j < N; ++j) {
+                    long long temp = pivot_row[j];
+                    pivot_row[j] = a[p * N + j];
+                    a[p * N + j] = temp;
+                }
+                sign = -sign;
+            }
+            W pivot = pivot_row[k];
+
+            for (dimension_t i = k + 1; i < N; ++i) {
+                long long *row = a + i * N;
+                W factor = row[k];
+
+                for (dimension_t j = k + 1; j < N; ++j) {
+                    W minor = ((W) row[j] * pivot - factor * (W) pivot_row[j]) / previous;
+                    if constexpr (!std::is_same<W, long long>::value) {
+                        if (minor > LLONG_MAX || minor < LLONG_MIN)
+                            return false;
+                    }
+                    row[j] = (long long) minor;
+                }
+            }
+            previous = pivot_row[k];
+        }
+        return true;
+    }
+
+    /*  Writes the exact determinant of a matrix with integral scalars into
+     *  det and returns true. If the determinant (or one of the minors of
+     *  the elimination) does not fit in a long long, an error is printed,
+     *  det is left unchanged and false is returned: modularDeterminant
+     *  handles such matrices.
+     */
+    template <typename T>
+    bool bareissDeterminant(const sqr_matrix<T> &arg, long long &det) {
+        static_assert(std::is_integral<T>::value, "Exact determinants require integral scalars");
+
+        double bound = hadamardBound(arg);
+        if (bound == -INFINITY) {
+            det = 0;
+            return true;
+        }
+
+        dimension_t N = arg.dimension();
+        auto *a = new long long[(std::size_t) (N * N)];
+
+        for (dimension_t i = 0; i < N; ++i) {
+            for (dimension_t j = 0; j < N; ++j) {
+                a[i * N + j] = (long long) arg[i][j];
+            }
+        }
+
+        int sign = 1;
+        bool fits = bound < 31 ? eliminateBareiss<long long>(a, N, sign)
+                               : eliminateBareiss<__int128>(a, N, sign);
+        long long value = sign * a[N * N - 1];
+
+        delete[] a;
+
+        if (!fits) {
+            std::cerr << "Error: the determinant does not fit in a long long" << std::endl;
+            return false;
+        }
+        det = value;
+        return true;
+    }
+
+    /*  Returns the determinant modulo the prime p < 2^31, by Gaussian
+     *  elimination over GF(p). The trailing rows are updated without
+     *  reduction, as multiplyAddMod does, and only Barrett-reduced when
+     *  another update could overflow 64 bits; the pivot row and column are
+     *  reduced at every step, before they are read.
+     */
+    template <typename T>
+    residue_t determinantMod(const sqr_matrix<T> &arg, residue_t p) {
+        dimension_t N = arg.dimension();
+        auto *a = new residue_t[(std::size_t) (N * N)];
+
+        for (dimension_t i = 0; i < N; ++i) {
+            for (dimension_t j = 0; j < N; ++j) {
+                if constexpr (std::is_signed<T>::value) {
+                    a[i * N + j] = reduceMod((long long) arg[i][j], p);
+                } else {
+                    a[i * N + j] = (residue_t) arg[i][j] % p;
+                }
+            }
+        }
+
+        residue_t det = 1;
+        residue_t barrett = barrettFactor(p);
+        // Updates summed before a reduction, the scalars starting below p
+        residue_t delay = (~0ULL - (p - 1)) / ((p - 1) * (p - 1));
+        residue_t pending = 0;
+
+        for (dimension_t k = 0; k < N && det != 0; ++k) {
+            residue_t *pivot_row = a + k * N;
+
+            if (pending == delay) {
+                for (dimension_t i = k; i < N; ++i) {
+                    reduceRow(N - k, a + i * N + k, p, barrett);
+                }
+                pending = 0;
+            }
+            for (dimension_t i = k; i < N; ++i) {
+                a[i * N + k] = reduceBarrett(a[i * N + k], p, barrett);
+            }
+
+            dimension_t q = k;
+            while (q < N && a[q * N + k] == 0)
+                ++q;
+            if (q == N) {
+                det = 0;
+                break;
+            }
+            if (q != k) {
+                for (dimension_t j = k; j < N; ++j) {
+                    residue_t temp = pivot_row[j];
+                    pivot_row[j] = a[q * N + j];
+                    a[q * N + j] = temp;
+                }
+                det = p - det;
+            }
+            reduceRow(N - k - 1, pivot_row + k + 1, p, barrett);
+            det = mulMod(det, pivot_row[k], p);
+            residue_t inverse = inverseMod(pivot_row[k], p);
+
+            for (dimension_t i = k + 1; i < N; ++i) {
+                residue_t *row = a + i * N;
+                if (row[k] == 0)
+                    continue;
+
+                // row = row - (row[k] / pivot) * pivot_row, every product below 2^62
+                residue_t factor = p - mulMod(row[k], inverse, p);
+                updateRow(N - k - 1, factor, pivot_row + k + 1, row + k + 1);
+            }
+            ++pending;
+        }
+        delete[] a;
+
+        return det;
+    }
+
+    /*  Returns the exact determinant of a matrix with integral scalars, by
+     *  Chinese remaindering over primes below 2^31, computing the residues
+     *  for one prime per thread (one thread per core by default).
+     *
+     *  The value is kept as the symmetric residue modulo M, the product of
+     *  the primes used so far. For the next prime p, with r = det mod p:
+     *      det = det + M * t,  where  t = (r - det) / M  mod p,  |t| <= p / 2
+     *  so that t == 0 exactly when the new prime leaves the value unchanged.
+     */
+    template <typename T>
+    big_integer modularDeterminant(const sqr_matrix<T> &arg, unsigned int threads) {
+        static_assert(std::is_integral<T>::value, "Exact determinants require integral scalars");
+
+        double bound = hadamardBound(arg);
+        if (bound == -INFINITY) {
+            return big_integer(0);
+        }
+        if (threads == 0) {
+            threads = defaultThreads();
+        }
+
+        big_integer det(0);
+        big_integer modulus(1);
+        double modulus_bits = 0;
+        int unchanged = 0;
+        residue_t prime = CRT_FIRST_PRIME + 1;
+
+        std::vector<residue_t> primes(threads);
+        std::vector<residue_t> residues(threads);
+
+        // |det| <= 2^bound, so a modulus above 2^(bound + 1) determines it (one more bit against rounding)
+        auto finished = [&]() { return modulus_bits > bound + 2 || unchanged >= CRT_EARLY_TERMINATION; };
+
+        while (!finished()) {
+            task_graph graph;
+
+            for (unsigned int t = 0; t < threads; ++t) {
+                prime = previousPrime(prime);
+                primes[t] = prime;
+                graph.addTask([&arg, &primes, &residues, t]() {
+                    residues[t] = determinantMod(arg, primes[t]);
+                });
+            }
+            graph.run(threads);
+
+            for (unsigned int t = 0; t < threads && !finished(); ++t) {
+                residue_t p = primes[t];
+                residue_t difference = (residues[t] + p - det.modulo(p)) % p;
+                residue_t step = mulMod(difference, inverseMod(modulus.modulo(p), p), p);
+
+                if (step == 0) {
+                    ++unchanged;
+                } else {
+                    unchanged = 0;
+                    det += modulus * (step > p / 2 ? (long long) step - (long long) p : (long long) step);
+                }
+                modulus *= (unsigned int) p;
+                modulus_bits += std::log2((double) p);
+            }
+        }
+        return det;
+    }
+}
+
+
+#endif // INTEGER_H
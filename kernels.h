@@ -0,0 +1,240 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cmath>
+
+
+/*                  DENSE LINEAR ALGEBRA KERNELS
+ *
+ *  Building blocks for the blocked factorizations, working on row-major
+ *  sub-blocks of a buffer, addressed by a pointer to their first scalar
+ *  and the leading dimension (row stride) of the buffer.
+ *
+ *  The matrix multiplication is tiled so that a KC x NC block of the
+ *  second factor stays in cache while every row of the first factor
+ *  streams over it, and four rows of the product are updated together
+ *  so that each loaded scalar of the second factor is used four times.
+ */
+
+namespace algebra {
+    typedef long long dimension_t;  // same data type as in matrix.h
+
+    const dimension_t KERNEL_BLOCK_K = 128;    // KC -- rows of the cached block of B
+    const dimension_t KERNEL_BLOCK_N = 512;    // NC -- columns of the cached block of B
+    const dimension_t KERNEL_BLOCK_TRSM = 64;  // Rows per diagonal block of the triangular solves
+
+    template <typename T> double magnitude(T);
+    template <typename T> void multiplyAdd(dimension_t, dimension_t, dimension_t, T, const T *, dimension_t, const T *, dimension_t, T *, dimension_t);
+    template <typename T> void multiplyAddTransposed(dimension_t, dimension_t, dimension_t, T, const T *, dimension_t, const T *, dimension_t, T *, dimension_t);
+    template <typename T> void solveUnitLower(dimension_t, dimension_t, const T *, dimension_t, T *, dimension_t);
+    template <typename T> void solveUpper(dimension_t, dimension_t, const T *, dimension_t, T *, dimension_t);
+    template <typename T> void solveUpperTransposed(dimension_t, dimension_t, const T *, dimension_t, T *, dimension_t);
+    template <typename T> void multiplyUpper(dimension_t, dimension_t, const T *, dimension_t, T *, dimension_t);
+
+
+    // --- BLUEPRINTS ---
+
+    // Absolute value of a real scalar, the pivot size of the factorizations; complex.h overloads it
+    template <typename T>
+    double magnitude(T scalar) {
+        return (double) std::abs(scalar);
+    }
+
+    // c0 ... c3 += a0 ... a3 * b, over n contiguous scalars
+    template <typename T>
+    void updateRows(dimension_t n, T a0, T a1, T a2, T a3, const T *__restrict b,
+                    T *__restrict c0, T *__restrict c1, T *__restrict c2, T *__restrict c3) {
+        for (dimension_t j = 0; j < n; ++j) {
+            T scalar = b[j];
+            c0[j] += a0 * scalar;
+            c1[j] += a1 * scalar;
+            c2[j] += a2 * scalar;
+            c3[j] += a3 * scalar;
+        }
+    }
+
+    // c += a * b, over n contiguous scalars
+    template <typename T>
+    void updateRow(dimension_t n, T a, const T *__restrict b, T *__restrict c) {
+        for (dimension_t j = 0; j < n; ++j) {
+            c[j] += a * b[j];
+        }
+    }
+
+    /*  GEMM: C += alpha * A * B, where A is M x K, B is K x N and C is M x N.
+     *  C must not overlap with A or B.
+     */
+    template <typename T>
+    void multiplyAdd(dimension_t M, dimension_t N, dimension_t K, T alpha,
+                     const T *A, dimension_t lda, const T *B, dimension_t ldb, T *C, dimension_t ldc) {
+        for (dimension_t kk = 0; kk < K; kk += KERNEL_BLOCK_K) {
+            dimension_t k_end = kk + KERNEL_BLOCK_K < K ? kk + KERNEL_BLOCK_K : K;
+
+            for (dimension_t jj = 0; jj < N; jj += KERNEL_BLOCK_N) {
+                dimension_t width = jj + KERNEL_BLOCK_N < N ? KERNEL_BLOCK_N : N - jj;
+                dimension_t i = 0;
+
+                for (; i + 4 <= M; i += 4) {
+                    const T *a = A + i * lda;
+                    T *c = C + i * ldc + jj;
+
+                    for (dimension_t k = kk; k < k_end; ++k) {
+                        updateRows(width,
+                                   alpha * a[k], alpha * a[lda + k], alpha * a[2 * lda + k], alpha * a[3 * lda + k],
+                                   B + k * ldb + jj, c, c + ldc, c + 2 * ldc, c + 3 * ldc);
+                    }
+                }
+                for (; i < M; ++i) {
+                    const T *a = A + i * lda;
+                    T *c = C + i * ldc + jj;
+
+                    for (dimension_t k = kk; k < k_end; ++k) {
+                        updateRow(width, alpha * a[k], B + k * ldb + jj, c);
+                    }
+                }
+            }
+        }
+    }
+
+    /*  GEMM: C += alpha * A^T * B, where A is K x M, B is K x N and C is M x N.
+     *  Tiled as above, row k of A supplies the multipliers of four rows of C
+     *  from contiguous scalars. C must not overlap with A or B.
+     */
+    template <typename T>
+    void multiplyAddTransposed(dimension_t M, dimension_t N, dimension_t K, T alpha,
+                               const T *A, dimension_t lda, const T *B, dimension_t ldb, T *C, dimension_t ldc) {
+        for (dimension_t kk = 0; kk < K; kk += KERNEL_BLOCK_K) {
+            dimension_t k_end = kk + KERNEL_BLOCK_K < K ? kk + KERNEL_BLOCK_K : K;
+
+            for (dimension_t jj = 0; jj < N; jj += KERNEL_BLOCK_N) {
+                dimension_t width = jj + KERNEL_BLOCK_N < N ? KERNEL_BLOCK_N : N - jj;
+                dimension_t i = 0;
+
+                for (; i + 4 <= M; i += 4) {
+                    T *c = C + i * ldc + jj;
+
+                    for (dimension_t k = kk; k < k_end; ++k) {
+                        const T *a = A + k * lda + i;
+                        updateRows(width, alpha * a[0], alpha * a[1], alpha * a[2], alpha * a[3],
+                                   B + k * ldb + jj, c, c + ldc, c + 2 * ldc, c + 3 * ldc);
+                    }
+                }
+                for (; i < M; ++i) {
+                    T *c = C + i * ldc + jj;
+
+                    for (dimension_t k = kk; k < k_end; ++k) {
+                        updateRow(width, alpha * A[k * lda + i], B + k * ldb + jj, c);
+                    }
+                }
+            }
+        }
+    }
+
+    /*  TRSM: B = L^-1 * B, where L is an M x M unit lower triangular matrix
+     *  (only its strictly lower part is read) and B is M x N.
+     *
+     *  Blocked by KERNEL_BLOCK_TRSM rows: each diagonal block is solved by
+     *  substitution and the rows below it are then updated at once, by a
+     *  multiplication, so that most of the flops run through multiplyAdd.
+     */
+    template <typename T>
+    void solveUnitLower(dimension_t M, dimension_t N, const T *L, dimension_t ldl, T *B, dimension_t ldb) {
+        for (dimension_t k0 = 0; k0 < M; k0 += KERNEL_BLOCK_TRSM) {
+            dimension_t k1 = k0 + KERNEL_BLOCK_TRSM < M ? k0 + KERNEL_BLOCK_TRSM : M;
+
+            for (dimension_t i = k0 + 1; i < k1; ++i) {
+                T *row = B + i * ldb;
+                for (dimension_t k = k0; k < i; ++k) {
+                    updateRow(N, (T) 0 - L[i * ldl + k], B + k * ldb, row);
+                }
+            }
+            if (k1 < M) {
+                multiplyAdd(M - k1, N, k1 - k0, (T) -1, L + k1 * ldl + k0, ldl, B + k0 * ldb, ldb, B + k1 * ldb, ldb);
+            }
+        }
+    }
+
+    /*  TRSM: B = U^-1 * B, where U is an M x M upper triangular matrix
+     *  (only its upper part is read) with a non-zero diagonal and B is M x N.
+     *  Blocked as above, from the bottom diagonal block upwards.
+     */
+    template <typename T>
+    void solveUpper(dimension_t M, dimension_t N, const T *U, dimension_t ldu, T *B, dimension_t ldb) {
+        dimension_t k1 = M;
+
+        while (k1 > 0) {
+            dimension_t k0 = k1 > KERNEL_BLOCK_TRSM ? k1 - KERNEL_BLOCK_TRSM : 0;
+
+            for (dimension_t i = k1 - 1; i >= k0; --i) {
+                T *row = B + i * ldb;
+                for (dimension_t k = i + 1; k < k1; ++k) {
+                    updateRow(N, (T) 0 - U[i * ldu + k], B + k * ldb, row);
+                }
+                T reciprocal = (T) 1 / U[i * ldu + i];
+                for (dimension_t j = 0; j < N; ++j) {
+                    row[j] *= reciprocal;
+                }
+            }
+            if (k0 > 0) {
+                multiplyAdd(k0, N, k1 - k0, (T) -1, U + k0, ldu, B + k0 * ldb, ldb, B, ldb);
+            }
+            k1 = k0;
+        }
+    }
+
+    /*  TRSM: B = U^-T * B, where U is an M x M upper triangular matrix
+     *  (only its upper part is read) with a non-zero diagonal and B is M x N.
+     *  U^T is lower triangular, so the blocks are solved top-down, and the
+     *  rows below each one are updated through multiplyAddTransposed.
+     */
+    template <typename T>
+    void solveUpperTransposed(dimension_t M, dimension_t N, const T *U, dimension_t ldu, T *B, dimension_t ldb) {
+        for (dimension_t k0 = 0; k0 < M; k0 += KERNEL_BLOCK_TRSM) {
+            dimension_t k1 = k0 + KERNEL_BLOCK_TRSM < M ? k0 + KERNEL_BLOCK_TRSM : M;
+
+            for (dimension_t i = k0; i < k1; ++i) {
+                T *row = B + i * ldb;
+                for (dimension_t k = k0; k < i; ++k) {
+                    updateRow(N, (T) 0 - U[k * ldu + i], B + k * ldb, row);
+                }
+                T reciprocal = (T) 1 / U[i * ldu + i];
+                for (dimension_t j = 0; j < N; ++j) {
+                    row[j] *= reciprocal;
+                }
+            }
+            if (k1 < M) {
+                multiplyAddTransposed(M - k1, N, k1 - k0, (T) -1, U + k0 * ldu + k1, ldu, B + k0 * ldb, ldb, B + k1 * ldb, ldb);
+            }
+        }
+    }
+
+    /*  TRMM: B = U * B in place, where U is an M x M upper triangular matrix
+     *  (only its upper part is read) and B is M x N. Blocked as the solves:
+     *  every block of rows is first multiplied by its diagonal block, top-down
+     *  so that each row only reads rows not overwritten yet, and then gets
+     *  the contribution of all the rows below it by one multiplication.
+     */
+    template <typename T>
+    void multiplyUpper(dimension_t M, dimension_t N, const T *U, dimension_t ldu, T *B, dimension_t ldb) {
+        for (dimension_t i0 = 0; i0 < M; i0 += KERNEL_BLOCK_TRSM) {
+            dimension_t i1 = i0 + KERNEL_BLOCK_TRSM < M ? i0 + KERNEL_BLOCK_TRSM : M;
+
+            for (dimension_t i = i0; i < i1; ++i) {
+                T *row = B + i * ldb;
+                T diagonal = U[i * ldu + i];
+                for (dimension_t j = 0; j < N; ++j) {
+                    row[j] *= diagonal;
+                }
+                for (dimension_t k = i + 1; k < i1; ++k) {
+                    updateRow(N, U[i * ldu + k], B + k * ldb, row);
+                }
+            }
+            if (i1 < M) {
+                multiplyAdd(i1 - i0, N, M - i1, (T) 1, U + i0 * ldu + i1, ldu, B + i1 * ldb, ldb, B + i0 * ldb, ldb);
+            }
+        }
+    }
+}
+
+
+#endif // KERNELS_H
@@ -0,0 +1,574 @@
+#ifndef LU_H
+#define LU_H
+
+#include <cmath>
+#include <vector>
+
+#include "kernels.h"    // GEMM and TRSM kernels for the blocked engines
+#include "strassen.h"   // Fast multiplication for the sub-cubic engine
+#include "parallel.h"   // Task graph scheduler for the tiled engine
+
+
+/*                  LU FACTORIZATION KERNELS
+ *
+ *  PA = LU factorization with partial pivoting, working in place on
+ *  a row-major buffer with leading dimension lda. On exit the strictly
+ *  lower part of the buffer holds L (whose unit diagonal is implied)
+ *  and the upper part holds U, so both factors share one allocation.
+ *
+ *  Row interchanges are recorded LAPACK-style: perm[k] is the row that
+ *  was swapped with row k at step k. Applying the swaps k = 0, 1, ...
+ *  in order to any matrix applies the permutation P.
+ *
+ *  factorLU is the unblocked engine, its rank-1 updates touch the whole
+ *  trailing matrix once per column. factorBlockedLU factorizes panels of
+ *  LU_BLOCK_SIZE columns with it and then updates the trailing matrix
+ *  with a single matrix multiplication per panel, so that most of the
+ *  O(n^3) work runs through the cache-blocked kernels of kernels.h.
+ *
+ *  factorTiledLU is the multithreaded engine: the same algorithm is split
+ *  into tasks over LU_TILE_SIZE x LU_TILE_SIZE tiles and executed by the
+ *  task_graph scheduler of parallel.h (see the function for details).
+ *
+ *  factorRecursiveLU is the cache-oblivious engine: it halves the columns
+ *  recursively and expresses the updates as matrix multiplications, so
+ *  its blocking adapts to every cache level without a tuned block size.
+ *
+ *  factorFastLU is the same recursion with every multiplication and
+ *  triangular solve done by Strassen's algorithm (strassen.h), so the
+ *  factorization, and the determinant with it, costs O(n^2.807).
+ *
+ *  factorSquareLU dispatches to one of the engines above.
+ *
+ *  The determinant of the factorized matrix is the signed product of the
+ *  pivots, which overflows IEEE754 doubles already for moderate N, even
+ *  when every pivot is of order 1e3. pivotProduct keeps it in the form
+ *  mantissa * 2^exponent instead, renormalizing after every factor.
+ *
+ *  invertFactorizedLU turns the factors into the inverse, in the same
+ *  buffer: A^-1 = U^-1 L^-1 P, with U^-1 formed in place by invertUpper
+ *  and then X L = U^-1 solved for X one block of columns at a time, from
+ *  right to left, with the block of L moved to an N x LU_BLOCK_SIZE
+ *  workspace. Both steps are blocked, their bulk runs through multiplyAdd.
+ */
+
+namespace algebra {
+    typedef long long dimension_t;  // same data type as in matrix.h
+
+    const dimension_t LU_BLOCK_SIZE = 64;   // Columns per panel of the blocked engine
+    const dimension_t LU_TILE_SIZE = 128;   // Rows and columns per tile of the tiled engine
+    const dimension_t LU_RECURSION_CUTOFF = 8;  // Narrowest panel split by the recursive engine
+
+    // The engines that can factorize a square matrix
+    enum class lu_engine {
+        automatic,  // tiled on multiple cores, blocked otherwise
+        unblocked,
+        blocked,
+        tiled,
+        recursive,
+        fast        // sub-cubic, through Strassen's multiplication
+    };
+
+    // Determinant in the form mantissa * 2^exponent, with 0.5 <= |mantissa| < 1 or mantissa == 0
+    struct scaled_determinant {
+        double mantissa;
+        long long exponent;
+    };
+
+    // Determinant in the form sign * e^logarithm, sign == 0 (logarithm == -inf) for singular matrices
+    struct log_determinant {
+        int sign;
+        double logarithm;
+    };
+
+    template <typename T> int factorLU(T *, dimension_t, dimension_t, dimension_t, dimension_t *);
+    template <typename T> int factorBlockedLU(T *, dimension_t, dimension_t, dimension_t *);
+    template <typename T> int factorTiledLU(T *, dimension_t, dimension_t, dimension_t *, unsigned int threads = 0);
+    template <typename T> int factorRecursiveLU(T *, dimension_t, dimension_t, dimension_t, dimension_t *);
+    template <typename T> int factorFastLU(T *, dimension_t, dimension_t, dimension_t, dimension_t *);
+    template <typename T> int factorSquareLU(T *, dimension_t, dimension_t, dimension_t *, lu_engine engine = lu_engine::automatic);
+    template <typename T> void invertUpper(T *, dimension_t, dimension_t);
+    template <typename T> void invertFactorizedLU(T *, dimension_t, dimension_t, const dimension_t *);
+    template <typename T> bool invertLU(T *, dimension_t, dimension_t, lu_engine engine = lu_engine::automatic);
+    template <typename T> scaled_determinant pivotProduct(const T *, dimension_t, dimension_t, int);
+    log_determinant logarithmOf(const scaled_determinant &);
+    template <typename T> void swapRows(T *, dimension_t, dimension_t, dimension_t, const dimension_t *, dimension_t, dimension_t);
+
+
+    // --- BLUEPRINTS ---
+
+    /*  Factorizes the M x N panel a (M >= N) in place and returns the sign
+     *  of the permutation (+1 or -1).
+     *
+     *  Every step scans column k once to find the pivot and then updates
+     *  the trailing rows with contiguous row operations, so the innermost
+     *  loop always walks along a row of the buffer. A zero pivot column is
+     *  left untouched, in which case U has a zero on its diagonal.
+     */
+    template <typename T>
+    int factorLU(T *a, dimension_t M, dimension_t N, dimension_t lda, dimension_t *perm) {
+        int sign = 1;
+
+        for (dimension_t k = 0; k < N; ++k) {
+            // Partial pivoting: the largest scalar of column k, on or below the diagonal
+            dimension_t p = k;
+            double max = magnitude(a[k * lda + k]);
+
+            for (dimension_t i = k + 1; i < M; ++i) {
+                double candidate = magnitude(a[i * lda + k]);
+                if (candidate > max) {
+                    max = candidate;
+                    p = i;
+                }
+            }
+            perm[k] = p;
+
+            if (p != k) {
+                T *row_k = a + k * lda;
+                T *row_p = a + p * lda;
+                for (dimension_t j = 0; j < N; ++j) {
+                    T temp = row_k[j];
+                    row_k[j] = row_p[j];
+                    row_p[j] = temp;
+                }
+                sign = -sign;
+            }
+
+            if (max == 0)
+                continue;
+
+            const T *pivot_row = a + k * lda;
+            T pivot = pivot_row[k];
+
+            for (dimension_t i = k + 1; i < M; ++i) {
+                T *row = a + i * lda;
+                T l = row[k] / pivot;
+                row[k] = l;
+                for (dimension_t j = k + 1; j < N; ++j) {
+                    row[j] -= l * pivot_row[j];
+                }
+            }
+        }
+        return sign;
+    }
+
+    /*  Right-looking blocked factorization of the N x N matrix a, returns the
+     *  sign of the permutation. For every panel of columns [k, k + b):
+     *      - the M x b panel is factorized by the unblocked engine
+     *      - its row interchanges are applied to the columns left and right of it
+     *      - the block row of U is solved:   A12 = L11^-1 * A12     (TRSM)
+     *      - the trailing matrix is updated: A22 = A22 - A21 * A12  (GEMM)
+     */
+    template <typename T>
+    int factorBlockedLU(T *a, dimension_t N, dimension_t lda, dimension_t *perm) {
+        if (N <= LU_BLOCK_SIZE) {
+            return factorLU(a, N, N, lda, perm);
+        }
+        int sign = 1;
+
+        for (dimension_t k = 0; k < N; k += LU_BLOCK_SIZE) {
+            dimension_t b = k + LU_BLOCK_SIZE < N ? LU_BLOCK_SIZE : N - k;
+            dimension_t rest = N - k - b;
+            T *a11 = a + k * lda + k;
+
+            sign *= factorLU(a11, N - k, b, lda, perm + k);
+            for (dimension_t i = k; i < k + b; ++i) {
+                perm[i] += k;
+            }
+
+            swapRows(a, lda, 0, k, perm, k, k + b);
+            swapRows(a, lda, k + b, N, perm, k, k + b);
+
+            if (rest > 0) {
+                T *a12 = a11 + b;
+                T *a21 = a11 + b * lda;
+                T *a22 = a21 + b;
+
+                solveUnitLower(b, rest, a11, lda, a12, lda);
+                multiplyAdd(rest, rest, b, (T) -1, a21, lda, a12, lda, a22, lda);
+            }
+        }
+        return sign;
+    }
+
+    /*  Tiled factorization of the N x N matrix a on the given number of threads
+     *  (one per core by default), returns the sign of the permutation. Falls
+     *  back to the blocked engine on a single thread or for small matrices.
+     *
+     *  Step k of the algorithm is split into the tasks:
+     *      - PANEL(k):      factorizes the column of tiles k, with partial pivoting
+     *      - SOLVE(k, j):   applies the interchanges of PANEL(k) to the column of
+     *                       tiles j and solves tile (k, j) of U   (TRSM)
+     *      - UPDATE(i, j):  A(i, j) = A(i, j) - A(i, k) * A(k, j)  (GEMM)
+     *  Each task waits only for the tasks that last wrote the tiles it reads or
+     *  writes (and for the readers of the tiles it overwrites), so PANEL(k + 1)
+     *  can start as soon as the column of tiles k + 1 is updated, while the
+     *  rest of the updates of step k are still running. Tasks closer to the
+     *  left of the matrix run first, which keeps the panels on the critical
+     *  path ahead of the trailing updates (lookahead).
+     *
+     *  The interchanges of every panel are applied to the columns left of it
+     *  after the graph has finished, since those tiles of L are still read by
+     *  the updates while it runs.
+     */
+    template <typename T>
+    int factorTiledLU(T *a, dimension_t N, dimension_t lda, dimension_t *perm, unsigned int threads) {
+        if (threads == 0) {
+            threads = defaultThreads();
+        }
+        // Too little work to keep more than one thread busy
+        if (threads == 1 || N <= 2 * LU_TILE_SIZE) {
+            return factorBlockedLU(a, N, lda, perm);
+        }
+        const dimension_t nb = LU_TILE_SIZE;
+        const dimension_t tiles = (N + nb - 1) / nb;
+        const task_graph::task_t none = (task_graph::task_t) -1;
+
+        auto tile = [&](dimension_t i, dimension_t j) { return a + i * nb * lda + j * nb; };
+        auto width = [&](dimension_t k) { return k == tiles - 1 ? N - k * nb : nb; };
+
+        task_graph graph;
+        std::vector<int> signs((std::size_t) tiles, 1);
+        std::vector<task_graph::task_t> last_writer((std::size_t) (tiles * tiles), none);
+        std::vector<std::vector<task_graph::task_t>> readers((std::size_t) (tiles * tiles));
+
+        // Registers the access of a task to tile (i, j), adding the dependencies it implies
+        auto access = [&](task_graph::task_t task, dimension_t i, dimension_t j, bool write) {
+            std::size_t index = (std::size_t) (i * tiles + j);
+
+            if (last_writer[index] != none && last_writer[index] != task) {
+                graph.addDependency(last_writer[index], task);
+            }
+            if (write) {
+                for (task_graph::task_t reader : readers[index]) {
+                    if (reader != task)
+                        graph.addDependency(reader, task);
+                }
+                readers[index].clear();
+                last_writer[index] = task;
+            } else {
+                readers[index].push_back(task);
+            }
+        };
+        auto priority = [&](dimension_t j, bool panel) { return (int) (2 * (tiles - j) + (panel ? 1 : 0)); };
+
+        for (dimension_t k = 0; k < tiles; ++k) {
+            dimension_t k0 = k * nb;
+            dimension_t b = width(k);
+
+            task_graph::task_t panel = graph.addTask([=, &signs]() {
+                signs[(std::size_t) k] = factorLU(a + k0 * lda + k0, N - k0, b, lda, perm + k0);
+                for (dimension_t i = k0; i < k0 + b; ++i) {
+                    perm[i] += k0;
+                }
+            }, priority(k, true));
+
+            for (dimension_t i = k; i < tiles; ++i) {
+                access(panel, i, k, true);
+            }
+
+            for (dimension_t j = k + 1; j < tiles; ++j) {
+                dimension_t j0 = j * nb;
+                dimension_t w = width(j);
+
+                task_graph::task_t solve = graph.addTask([=]() {
+                    swapRows(a, lda, j0, j0 + w, perm, k0, k0 + b);
+                    solveUnitLower(b, w, a + k0 * lda + k0, lda, a + k0 * lda + j0, lda);
+                }, priority(j, false));
+
+                access(solve, k, k, false);
+                for (dimension_t i = k; i < tiles; ++i) {
+                    access(solve, i, j, true);
+                }
+            }
+
+            for (dimension_t j = k + 1; j < tiles; ++j) {
+                for (dimension_t i = k + 1; i < tiles; ++i) {
+                    task_graph::task_t update = graph.addTask([=]() {
+                        multiplyAdd(width(i), width(j), b, (T) -1, tile(i, k), lda, tile(k, j), lda, tile(i, j), lda);
+                    }, priority(j, false));
+
+                    access(update, i, k, false);
+                    access(update, k, j, false);
+                    access(update, i, j, true);
+                }
+            }
+        }
+        graph.run(threads);
+
+        int sign = 1;
+        for (dimension_t k = 0; k < tiles; ++k) {
+            swapRows(a, lda, 0, k * nb, perm, k * nb, k * nb + width(k));
+            sign *= signs[(std::size_t) k];
+        }
+        return sign;
+    }
+
+    /*  Recursive (Toledo) factorization of the M x N panel a (M >= N), returns
+     *  the sign of the permutation. The columns are split in halves [A1 | A2]:
+     *      - the left half A1 is factorized recursively
+     *      - its interchanges are applied to A2, and the top of A2 is solved:
+     *        A12 = L11^-1 * A12                                  (TRSM)
+     *      - the bottom of A2 is updated: A22 = A22 - A21 * A12  (GEMM)
+     *      - A22 is factorized recursively and its interchanges are applied to A21
+     *  Half of the flops of every level go through the multiplication, on
+     *  blocks that shrink geometrically down to LU_RECURSION_CUTOFF columns.
+     */
+    template <typename T>
+    int factorRecursiveLU(T *a, dimension_t M, dimension_t N, dimension_t lda, dimension_t *perm) {
+        if (N <= LU_RECURSION_CUTOFF) {
+            return factorLU(a, M, N, lda, perm);
+        }
+        dimension_t n1 = N / 2;
+        dimension_t n2 = N - n1;
+        T *a12 = a + n1;
+        T *a21 = a + n1 * lda;
+        T *a22 = a21 + n1;
+
+        int sign = factorRecursiveLU(a, M, n1, lda, perm);
+
+        swapRows(a, lda, n1, N, perm, 0, n1);
+        solveUnitLower(n1, n2, a, lda, a12, lda);
+        multiplyAdd(M - n1, n2, n1, (T) -1, a21, lda, a12, lda, a22, lda);
+
+        sign *= factorRecursiveLU(a22, M - n1, n2, lda, perm + n1);
+        for (dimension_t i = n1; i < N; ++i) {
+            perm[i] += n1;
+        }
+        swapRows(a, lda, 0, n1, perm, n1, N);
+
+        return sign;
+    }
+
+    /*  Recursive factorization of the M x N panel a (M >= N) as above, with
+     *  the TRSM and the GEMM of every level done by fast multiplication.
+     *  With T(n) the cost of the square case, T(n) = 2 T(n / 2) + O(n^2.807),
+     *  the multiplications dominate every level and T(n) = O(n^2.807).
+     */
+    template <typename T>
+    int factorFastLU(T *a, dimension_t M, dimension_t N, dimension_t lda, dimension_t *perm) {
+        if (N <= STRASSEN_CUTOFF) {
+            return factorRecursiveLU(a, M, N, lda, perm);
+        }
+        dimension_t n1 = N / 2;
+        dimension_t n2 = N - n1;
+        T *a12 = a + n1;
+        T *a21 = a + n1 * lda;
+        T *a22 = a21 + n1;
+
+        int sign = factorFastLU(a, M, n1, lda, perm);
+
+        swapRows(a, lda, n1, N, perm, 0, n1);
+        solveUnitLowerFast(n1, n2, a, lda, a12, lda);
+        multiplyStrassen(M - n1, n2, n1, (T) -1, a21, lda, a12, lda, a22, lda);
+
+        sign *= factorFastLU(a22, M - n1, n2, lda, perm + n1);
+        for (dimension_t i = n1; i < N; ++i) {
+            perm[i] += n1;
+        }
+        swapRows(a, lda, 0, n1, perm, n1, N);
+
+        return sign;
+    }
+
+    // Factorizes the N x N matrix a with the given engine, returns the sign of the permutation
+    template <typename T>
+    int factorSquareLU(T *a, dimension_t N, dimension_t lda, dimension_t *perm, lu_engine engine) {
+        switch (engine) {
+            case lu_engine::unblocked:
+                return factorLU(a, N, N, lda, perm);
+            case lu_engine::blocked:
+                return factorBlockedLU(a, N, lda, perm);
+            case lu_engine::recursive:
+                return factorRecursiveLU(a, N, N, lda, perm);
+            case lu_engine::fast:
+                return factorFastLU(a, N, N, lda, perm);
+            case lu_engine::tiled:
+            case lu_engine::automatic:
+            default:
+                return factorTiledLU(a, N, lda, perm);
+        }
+    }
+
+    /*  Inverts the N x N upper triangular part of a in place, its diagonal must
+     *  not contain zeros. For every block of columns [j0, j1), with the block
+     *  left of it already inverted:
+     *      A12 = U11^-1 * A12                       (TRMM)
+     *      A22 = U22^-1                             (by substitution)
+     *      A12 = -A12 * U22^-1
+     */
+    template <typename T>
+    void invertUpper(T *a, dimension_t N, dimension_t lda) {
+        std::vector<T> row_buffer((std::size_t) LU_BLOCK_SIZE);
+
+        for (dimension_t j0 = 0; j0 < N; j0 += LU_BLOCK_SIZE) {
+            dimension_t j1 = j0 + LU_BLOCK_SIZE < N ? j0 + LU_BLOCK_SIZE : N;
+            dimension_t jb = j1 - j0;
+
+            multiplyUpper(j0, jb, a, lda, a + j0, lda);
+
+            // Diagonal block, column by column: column j is multiplied by the inverse already formed left of it
+            for (dimension_t j = j0; j < j1; ++j) {
+                T *diagonal = a + j * lda + j;
+                *diagonal = (T) 1 / *diagonal;
+                T factor = (T) 0 - *diagonal;
+
+                for (dimension_t i = j0; i < j; ++i) {
+                    T sum = (T) 0;
+                    for (dimension_t k = i; k < j; ++k) {
+                        sum += a[i * lda + k] * a[k * lda + j];
+                    }
+                    a[i * lda + j] = sum * factor;
+                }
+            }
+
+            // Rows above the diagonal block, each one multiplied by -U22^-1 from the right
+            for (dimension_t i = 0; i < j0; ++i) {
+                T *row = a + i * lda + j0;
+                for (dimension_t c = 0; c < jb; ++c) {
+                    row_buffer[c] = row[c];
+                }
+                for (dimension_t c = 0; c < jb; ++c) {
+                    T sum = (T) 0;
+                    for (dimension_t k = 0; k <= c; ++k) {
+                        sum += row_buffer[k] * a[(j0 + k) * lda + j0 + c];
+                    }
+                    row[c] = (T) 0 - sum;
+                }
+            }
+        }
+    }
+
+    /*  Overwrites the factors of the N x N matrix a, as left by the engines
+     *  above, with the inverse of the matrix. U must not have a zero on its
+     *  diagonal, i.e. the matrix must not be singular.
+     */
+    template <typename T>
+    void invertFactorizedLU(T *a, dimension_t N, dimension_t lda, const dimension_t *perm) {
+        invertUpper(a, N, lda);
+
+        // Solves X L = U^-1, blocks of columns from right to left
+        std::vector<T> work((std::size_t) (N * LU_BLOCK_SIZE));
+        dimension_t last = ((N - 1) / LU_BLOCK_SIZE) * LU_BLOCK_SIZE;
+
+        for (dimension_t j0 = last; j0 >= 0; j0 -= LU_BLOCK_SIZE) {
+            dimension_t jb = j0 + LU_BLOCK_SIZE < N ? LU_BLOCK_SIZE : N - j0;
+            dimension_t j1 = j0 + jb;
+
+            // Moves the block of L to the workspace, leaving zeros behind
+            for (dimension_t i = j0; i < N; ++i) {
+                for (dimension_t c = 0; c < jb && j0 + c < i; ++c) {
+                    work[(std::size_t) (i * jb + c)] = a[i * lda + j0 + c];
+                    a[i * lda + j0 + c] = (T) 0;
+                }
+            }
+
+            if (j1 < N) {
+                multiplyAdd(N, jb, N - j1, (T) -1, a + j1, lda, work.data() + j1 * jb, jb, a + j0, lda);
+            }
+
+            // X = X * L22^-1, L22 unit lower triangular, row by row
+            for (dimension_t i = 0; i < N; ++i) {
+                T *row = a + i * lda + j0;
+                for (dimension_t c = jb - 1; c >= 0; --c) {
+                    for (dimension_t k = c + 1; k < jb; ++k) {
+                        row[c] -= row[k] * work[(std::size_t) ((j0 + k) * jb + c)];
+                    }
+                }
+            }
+        }
+
+        // A^-1 = X P, the interchanges are undone on the columns, in reverse order
+        for (dimension_t k = N - 1; k >= 0; --k) {
+            dimension_t p = perm[k];
+            if (p == k)
+                continue;
+            for (dimension_t i = 0; i < N; ++i) {
+                T temp = a[i * lda + k];
+                a[i * lda + k] = a[i * lda + p];
+                a[i * lda + p] = temp;
+            }
+        }
+    }
+
+    /*  Replaces the N x N matrix a by its inverse: factorization and
+     *  inversion in the same buffer, with a workspace of N x LU_BLOCK_SIZE
+     *  scalars only. Returns false if the matrix is singular, a then holds
+     *  its factors.
+     *
+     *  The fast engine inverts sub-cubically instead, as A^-1 = U^-1 L^-1 P
+     *  by the recursive triangular solves of strassen.h applied to P, which
+     *  needs a copy of the factors.
+     */
+    template <typename T>
+    bool invertLU(T *a, dimension_t N, dimension_t lda, lu_engine engine) {
+        std::vector<dimension_t> perm((std::size_t) N);
+        factorSquareLU(a, N, lda, perm.data(), engine);
+
+        for (dimension_t i = 0; i < N; ++i) {
+            if (a[i * lda + i] == (T) 0)
+                return false;
+        }
+        if (engine != lu_engine::fast) {
+            invertFactorizedLU(a, N, lda, perm.data());
+            return true;
+        }
+
+        std::vector<T> factors((std::size_t) (N * N));
+        for (dimension_t i = 0; i < N; ++i) {
+            for (dimension_t j = 0; j < N; ++j) {
+                factors[(std::size_t) (i * N + j)] = a[i * lda + j];
+                a[i * lda + j] = i == j ? (T) 1 : (T) 0;
+            }
+        }
+        swapRows(a, lda, 0, N, perm.data(), 0, N);
+        solveUnitLowerFast(N, N, factors.data(), N, a, lda);
+        solveUpperFast(N, N, factors.data(), N, a, lda);
+        return true;
+    }
+
+    // Returns sign * (product of the diagonal of the factorized N x N matrix a), without overflow
+    template <typename T>
+    scaled_determinant pivotProduct(const T *a, dimension_t N, dimension_t lda, int sign) {
+        scaled_determinant det = {(double) sign, 0};
+
+        for (dimension_t i = 0; i < N; ++i) {
+            int exponent;
+            det.mantissa = std::frexp(det.mantissa * (double) a[i * lda + i], &exponent);
+            det.exponent += exponent;
+        }
+        if (det.mantissa == 0) {
+            det.exponent = 0;
+        }
+        return det;
+    }
+
+    // Converts a scaled determinant to its sign and natural logarithm
+    inline log_determinant logarithmOf(const scaled_determinant &det) {
+        if (det.mantissa == 0) {
+            return {0, -INFINITY};
+        }
+        return {det.mantissa > 0 ? 1 : -1, std::log(std::abs(det.mantissa)) + (double) det.exponent * std::log(2.0)};
+    }
+
+    // Applies the row interchanges perm[k1] ... perm[k2 - 1] to the columns [j1, j2) of a
+    template <typename T>
+    void swapRows(T *a, dimension_t lda, dimension_t j1, dimension_t j2,
+                  const dimension_t *perm, dimension_t k1, dimension_t k2) {
+        for (dimension_t k = k1; k < k2; ++k) {
+            if (perm[k] == k)
+                continue;
+
+            T *row_k = a + k * lda;
+            T *row_p = a + perm[k] * lda;
+            for (dimension_t j = j1; j < j2; ++j) {
+                T temp = row_k[j];
+                row_k[j] = row_p[j];
+                row_p[j] = temp;
+            }
+        }
+    }
+}
+
+
+#endif // LU_H
@@ -0,0 +1,350 @@
+#ifndef LU_FACTORIZATION_H
+#define LU_FACTORIZATION_H
+
+#include <iostream>
+#include <cmath>
+#include <cfloat>
+#include <type_traits>
+#include <vector>
+
+#include "matrix.h"
+#include "parallel.h"   // Right-hand sides solved in parallel
+
+
+/*                   LU FACTORIZATION CLASS
+ *
+ *  Keeps the PA = LU factorization of a square matrix, so that its
+ *  determinant, the solution of linear systems, its inverse, rank and
+ *  condition number all share a single O(n^3) factorization.
+ *
+ *  The factorization is lazy: the constructor only copies the matrix,
+ *  which is factorized in place by the first query that needs it. The
+ *  object is a snapshot, later changes to the matrix are not reflected,
+ *  since the scalars of a matrix can be written through its "[]" operator
+ *  without notice. The lazy evaluation is not thread-safe, call factorize()
+ *  before sharing the object among threads.
+ *
+ *  solve() splits the right-hand sides into panels of SOLVE_PANEL_WIDTH
+ *  columns, solved on separate threads, each one by the blocked TRSM of
+ *  kernels.h, so a wide B runs at near multiplication speed instead of
+ *  as one triangular solve per column.
+ */
+
+namespace algebra {
+    const dimension_t SOLVE_PANEL_WIDTH = 128;  // Right-hand sides per task of solve()
+
+    template <class T>
+    class lu_factorization
+    {
+    protected:    // Class members
+        mutable sqr_matrix<double> m_lu;             // The matrix, then its packed factors L and U
+        mutable std::vector<dimension_t> m_perm;     // Row interchanges, head to lu.h for their format
+        mutable int m_sign;                          // Sign of the permutation P
+        mutable bool m_factorized;
+        double m_norm;                               // 1-norm of the matrix
+        lu_engine m_engine;
+
+    protected:
+        void permute(double *, bool) const;
+        void solveVector(std::vector<double> &) const;
+        void solveTransposedVector(std::vector<double> &) const;
+        bool isSingular() const;
+
+    public: // Constructors
+        lu_factorization() = delete;
+        explicit lu_factorization(const sqr_matrix<T> &, lu_engine engine = lu_engine::automatic);
+
+    public: // Methods
+        void factorize() const;
+        bool isFactorized() const { return m_factorized; }
+        dimension_t dimension() const { return m_lu.dimension(); }
+
+        lower_triangular<double> lower() const;
+        upper_triangular<double> upper() const;
+
+        double determinant() const;
+        scaled_determinant scaledDeterminant() const;
+        log_determinant slogdet() const;
+        matrix<double> solve(const matrix<double> &) const;
+        sqr_matrix<double> inverse() const;
+        dimension_t rank() const;
+        double conditionEstimate() const;
+    };
+
+    template <typename T> matrix<double> solve(const sqr_matrix<T> &, const matrix<T> &);
+
+
+    // --- BLUEPRINTS ---
+
+    // Explicit Constructor, copies the matrix without factorizing it
+    template <typename T>
+    lu_factorization<T>::lu_factorization(const sqr_matrix<T> &arg, lu_engine engine)
+            : m_lu(arg.dimension()), m_perm((std::size_t) arg.dimension()), m_sign(1), m_factorized(false),
+              m_norm(0), m_engine(engine) {
+        dimension_t N = arg.dimension();
+        std::vector<double> column_sums((std::size_t) N, 0.0);
+
+        for (dimension_t i = 0; i < N; ++i) {
+            for (dimension_t j = 0; j < N; ++j) {
+                m_lu[i][j] = (double) arg[i][j];
+                column_sums[(std::size_t) j] += std::abs(m_lu[i][j]);
+            }
+        }
+        for (double sum : column_sums) {
+            if (sum > m_norm)
+                m_norm = sum;
+        }
+    }
+
+
+    // --- METHODS ---
+
+    // Factorizes the matrix, if not already done
+    template <typename T>
+    void lu_factorization<T>::factorize() const {
+        if (!m_factorized) {
+            m_sign = factorSquareLU(m_lu[0], dimension(), dimension(), m_perm.data(), m_engine);
+            m_factorized = true;
+        }
+    }
+
+    // Applies P (forward == true) or P^-1 to the rows of the N x columns block b
+    template <typename T>
+    void lu_factorization<T>::permute(double *b, bool forward) const {
+        dimension_t N = dimension();
+
+        if (forward) {
+            swapRows(b, 1, 0, 1, m_perm.data(), 0, N);
+        } else {
+            for (dimension_t k = N - 1; k >= 0; --k) {
+                swapRows(b, 1, 0, 1, m_perm.data(), k, k + 1);
+            }
+        }
+    }
+
+    // Returns whether U has a zero on its diagonal
+    template <typename T>
+    bool lu_factorization<T>::isSingular() const {
+        factorize();
+        for (dimension_t i = 0; i < dimension(); ++i) {
+            if (m_lu[i][i] == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Solves A x = b in place, A must not be singular
+    template <typename T>
+    void lu_factorization<T>::solveVector(std::vector<double> &b) const {
+        dimension_t N = dimension();
+
+        permute(b.data(), true);
+        solveUnitLower(N, 1, m_lu[0], N, b.data(), 1);
+        solveUpper(N, 1, m_lu[0], N, b.data(), 1);
+    }
+
+    // Solves A^T x = b in place, A must not be singular
+    template <typename T>
+    void lu_factorization<T>::solveTransposedVector(std::vector<double> &b) const {
+        dimension_t N = dimension();
+
+        // A^T = U^T L^T P, forward substitution with U^T, then backward with L^T
+        for (dimension_t i = 0; i < N; ++i) {
+            b[i] /= m_lu[i][i];
+            for (dimension_t k = i + 1; k < N; ++k) {
+                b[k] -= m_lu[i][k] * b[i];
+            }
+        }
+        for (dimension_t i = N - 1; i >= 0; --i) {
+            for (dimension_t k = 0; k < i; ++k) {
+                b[k] -= m_lu[i][k] * b[i];
+            }
+        }
+        permute(b.data(), false);
+    }
+
+    // Returns the unit lower triangular factor L
+    template <typename T>
+    lower_triangular<double> lu_factorization<T>::lower() const {
+        factorize();
+        lower_triangular<double> L(dimension());
+
+        for (dimension_t i = 0; i < dimension(); ++i) {
+            for (dimension_t j = 0; j < i; ++j) {
+                L[i][j] = m_lu[i][j];
+            }
+            L[i][i] = 1;
+        }
+        return L;
+    }
+
+    // Returns the upper triangular factor U
+    template <typename T>
+    upper_triangular<double> lu_factorization<T>::upper() const {
+        factorize();
+        upper_triangular<double> U(dimension());
+
+        for (dimension_t i = 0; i < dimension(); ++i) {
+            for (dimension_t j = i; j < dimension(); ++j) {
+                U[i][j] = m_lu[i][j];
+            }
+        }
+        return U;
+    }
+
+    // Returns the determinant of the matrix
+    template <typename T>
+    double lu_factorization<T>::determinant() const {
+        scaled_determinant det = scaledDeterminant();
+        return std::ldexp(det.mantissa, (int) det.exponent);
+    }
+
+    // Returns the determinant as mantissa * 2^exponent
+    template <typename T>
+    scaled_determinant lu_factorization<T>::scaledDeterminant() const {
+        factorize();
+        return pivotProduct(m_lu[0], dimension(), dimension(), m_sign);
+    }
+
+    // Returns the sign and the natural logarithm of the absolute value of the determinant
+    template <typename T>
+    log_determinant lu_factorization<T>::slogdet() const {
+        return logarithmOf(scaledDeterminant());
+    }
+
+    // Returns X, the solution of A X = B, for every column of B
+    template <typename T>
+    matrix<double> lu_factorization<T>::solve(const matrix<double> &B) const {
+        if (B.numOfRows() != dimension()) {
+            std::cerr << "Error: cannot solve the linear system\n"
+                      << "Rows of the right-hand side do not match the matrix"
+                      << std::endl;
+            return matrix<double>(1, 1);
+        }
+        if (isSingular()) {
+            std::cerr << "Error: cannot solve the linear system, the matrix is singular" << std::endl;
+            return matrix<double>(1, 1);
+        }
+        matrix<double> X(B);
+        dimension_t N = dimension();
+        dimension_t columns = X.numOfCols();
+        dimension_t panels = (columns + SOLVE_PANEL_WIDTH - 1) / SOLVE_PANEL_WIDTH;
+        double *x = X[0];
+        const double *lu = m_lu[0];
+        const dimension_t *perm = m_perm.data();
+
+        parallelFor((std::size_t) panels, 1, [=](std::size_t first, std::size_t last) {
+            dimension_t j0 = (dimension_t) first * SOLVE_PANEL_WIDTH;
+            dimension_t j1 = (dimension_t) last * SOLVE_PANEL_WIDTH < columns ? (dimension_t) last * SOLVE_PANEL_WIDTH : columns;
+
+            swapRows(x, columns, j0, j1, perm, 0, N);
+            solveUnitLower(N, j1 - j0, lu, N, x + j0, columns);
+            solveUpper(N, j1 - j0, lu, N, x + j0, columns);
+        });
+
+        return X;
+    }
+
+    // Returns the inverse of the matrix, formed from a copy of the factors
+    template <typename T>
+    sqr_matrix<double> lu_factorization<T>::inverse() const {
+        if (isSingular()) {
+            std::cerr << "Error: cannot invert the matrix, it is singular" << std::endl;
+            return sqr_matrix<double>(1);
+        }
+        sqr_matrix<double> inv(m_lu);
+        invertFactorizedLU(inv[0], dimension(), dimension(), m_perm.data());
+        return inv;
+    }
+
+    /*  Returns the numerical rank, the number of pivots larger than
+     *  N * DBL_EPSILON times the largest one. Partial pivoting is not fully
+     *  rank-revealing, but this estimate is reliable for all but contrived
+     *  matrices.
+     */
+    template <typename T>
+    dimension_t lu_factorization<T>::rank() const {
+        factorize();
+        double largest = 0;
+
+        for (dimension_t i = 0; i < dimension(); ++i) {
+            if (std::abs(m_lu[i][i]) > largest)
+                largest = std::abs(m_lu[i][i]);
+        }
+        double tolerance = (double) dimension() * DBL_EPSILON * largest;
+        dimension_t rank = 0;
+
+        for (dimension_t i = 0; i < dimension(); ++i) {
+            if (std::abs(m_lu[i][i]) > tolerance)
+                ++rank;
+        }
+        return rank;
+    }
+
+    /*  Returns an estimate of the 1-norm condition number ||A|| * ||A^-1||,
+     *  infinite for singular matrices. ||A^-1|| is estimated by Hager's method,
+     *  which needs a few O(n^2) solves instead of the inverse itself.
+     */
+    template <typename T>
+    double lu_factorization<T>::conditionEstimate() const {
+        if (isSingular()) {
+            return INFINITY;
+        }
+        dimension_t N = dimension();
+        std::vector<double> x((std::size_t) N, 1.0 / (double) N);
+        double estimate = 0;
+
+        for (int iteration = 0; iteration < 5; ++iteration) {
+            std::vector<double> y(x);
+            solveVector(y);
+
+            estimate = 0;
+            for (double scalar : y) {
+                estimate += std::abs(scalar);
+            }
+
+            // z = A^-T sign(y), a subgradient of ||A^-1 x|| at x
+            std::vector<double> z((std::size_t) N);
+            for (dimension_t i = 0; i < N; ++i) {
+                z[i] = y[i] >= 0 ? 1.0 : -1.0;
+            }
+            solveTransposedVector(z);
+
+            dimension_t j = 0;
+            double z_x = 0;
+            for (dimension_t i = 0; i < N; ++i) {
+                z_x += z[i] * x[i];
+                if (std::abs(z[i]) > std::abs(z[j]))
+                    j = i;
+            }
+            if (std::abs(z[j]) <= z_x)
+                break;
+
+            x.assign((std::size_t) N, 0.0);
+            x[j] = 1.0;
+        }
+        return m_norm * estimate;
+    }
+
+    // Returns X, the solution of A X = B, by a one-off factorization of A
+    template <typename T>
+    matrix<double> solve(const sqr_matrix<T> &A, const matrix<T> &B) {
+        lu_factorization<T> lu(A);
+
+        if constexpr (std::is_same<T, double>::value) {
+            return lu.solve(B);
+        } else {
+            matrix<double> rhs(B.numOfRows(), B.numOfCols());
+
+            for (dimension_t i = 0; i < B.numOfRows(); ++i) {
+                for (dimension_t j = 0; j < B.numOfCols(); ++j) {
+                    rhs[i][j] = (double) B[i][j];
+                }
+            }
+            return lu.solve(rhs);
+        }
+    }
+}
+
+
+#endif // LU_FACTORIZATION_H
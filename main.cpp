@@ -3,13 +3,10 @@
 #include "algebra.h"
 
 
-/*              TODO: PA = LU decomposition problem
- *  During  the  decomposition  of  the  5x5 matrix found in matrices.txt
- *  the two triangular matrices, U and L, have shown to have an inf value
- *  as one of their elements.
- *
- *  Head to matrix.h file -- line 405 for more details.
- *  DO NOT EDIT THE MAIN FUNCTION BEFORE DOING SO
+/*                  UPDATE -- 18/10/2026:
+ *  The PA = LU decomposition now performs partial pivoting, so the
+ *  inf and NaN values that  showed up while decomposing  the 5x5
+ *  matrix found in matrices.txt are gone. Head to lu.h for more.
  */
 
 
@@ -6,6 +6,16 @@
 #include <exception>
 #include <type_traits>
 #include <cmath>
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "triangular.h"     // Lower and upper triangular matrices
+#include "exponentiation.h" // Addition chains of the exponents
+#include "modular.h"        // Arithmetic modulo word-size primes
+#include "lu.h"             // PA = LU factorization kernels
+#include "cholesky.h"       // A = R^T R factorization kernels
 
 
 /*                           MATRIX CLASS
@@ -303,13 +313,19 @@ namespace algebra {
      *  A subclass for square matrices, it has extra,
      *  special properties such as exponentiation and
      *  determinant calculation
+     *
+     *  A matrix can be flagged as symmetric positive-definite, a promise
+     *  of the caller that is neither checked nor cleared when the scalars
+     *  change. The determinant of a flagged matrix is computed by Cholesky,
+     *  with half the flops of LU, falling back to LU if the factorization
+     *  breaks down.
      */
 
     template <class T>
     class sqr_matrix : public matrix<T>
     {
-    protected:
-        void decomposeLU(sqr_matrix<double> &, sqr_matrix<double> &) const;
+    protected:    // Class members
+        bool m_positive_definite;   // Flagged by the caller as symmetric positive-definite
 
     public: // Constructors
         sqr_matrix() = delete;
@@ -318,8 +334,18 @@ namespace algebra {
 
     public: // Methods
         dimension_t dimension() const { return this->m_rows; }
-        sqr_matrix<T> pow(long long) const;
-        double determinant() const;
+        void setPositiveDefinite(bool flag = true) { m_positive_definite = flag; }
+        bool isPositiveDefinite() const { return m_positive_definite; }
+        sqr_matrix<T> pow(long long, int buffers = EXPONENT_DEFAULT_BUFFERS) const;
+        sqr_matrix<T> powMod(unsigned long long, residue_t) const;
+        int decomposeLU(sqr_matrix<double> &, dimension_t *, lu_engine engine = lu_engine::automatic) const;
+        int decomposeLU(lower_triangular<double> &, upper_triangular<double> &, dimension_t *,
+                        lu_engine engine = lu_engine::automatic) const;
+        double determinant(lu_engine engine = lu_engine::automatic) const;
+        scaled_determinant scaledDeterminant(lu_engine engine = lu_engine::automatic) const;
+        log_determinant slogdet(lu_engine engine = lu_engine::automatic) const;
+        sqr_matrix<double> inverse(lu_engine engine = lu_engine::automatic) const;
+        bool invert(lu_engine engine = lu_engine::automatic);
 
     public: // Operators
         sqr_matrix<T> &operator = (const sqr_matrix<T> &);
@@ -339,7 +365,7 @@ namespace algebra {
 
     // Explicit Constructor
     template <typename T>
-    sqr_matrix<T>::sqr_matrix(dimension_t N, bool UNARY) : matrix<T>(N, N) {
+    sqr_matrix<T>::sqr_matrix(dimension_t N, bool UNARY) : matrix<T>(N, N), m_positive_definite(false) {
         // If UNARY == true, a unary matrix (In) of dimension N is returned. Default value of UNARY evaluates to false
         if (UNARY) {
             this->init((T)0);
@@ -350,116 +376,238 @@ namespace algebra {
 
     // Copy Constructor
     template <typename T>
-    sqr_matrix<T>::sqr_matrix(const sqr_matrix<T> &prototype) : matrix<T>(prototype) {}
+    sqr_matrix<T>::sqr_matrix(const sqr_matrix<T> &prototype)
+            : matrix<T>(prototype), m_positive_definite(prototype.m_positive_definite) {}
 
 
     // --- METHODS ---
 
-    /*  Returns the matrix to the power of the argument,
-     *  the following algorithm strives for efficient exponentiation
-     *  with O(log2(exp)) time complexity, where exp is the exponent
+    /*  Returns the matrix to the power of the argument, one multiplication
+     *  per step of the shortest addition chain of the exponent needing at
+     *  most "buffers" working matrices (head to exponentiation.h). Products
+     *  are written into buffers recycled as soon as the terms they hold are
+     *  no longer needed, and the last one becomes the result, so by default
+     *  four N x N matrices are alive at peak, this one included; a budget
+     *  of 2 keeps it at three, with the binary chain, a larger one allows
+     *  shorter chains for large exponents.
      */
     template <typename T>
-    sqr_matrix<T> sqr_matrix<T>::pow(long long exp) const {
+    sqr_matrix<T> sqr_matrix<T>::pow(long long exp, int buffers) const {
         if (exp <= 1) {
             if (exp <= 0)
                 std::cerr << "Error: Exponent of matrix must be greater than zero!" << std::endl;
             return (*this);
         }
-        if (exp == 2) {
-            return (*this) * (*this);
-        }
-        if (exp == 3) {
-            return (*this) * (*this) * (*this);
-        }
+        dimension_t N = this->dimension();
+        std::vector<chain_step> chain = additionChain((unsigned long long) exp, buffers);
+        int count;
+        std::vector<int> buffer = assignBuffers(chain, &count);
+
+        std::deque<sqr_matrix<T>> storage;
+        for (int b = 0; b < count; ++b)
+            storage.emplace_back(N);
+
+        // Scalars of term k, term 0 being the matrix itself
+        auto term = [&](int k) -> T * { return k == 0 ? this->m_matrix : storage[buffer[k]].m_matrix; };
 
-        std::size_t len = (int) log2(exp) + 2;
-        auto **p = new sqr_matrix<T> *[len];
+        for (std::size_t k = 0; k < chain.size(); ++k) {
+            T *product = term((int) k + 1);
 
-        for (std::size_t k = 0; k < len; ++k) {
-            p[k] = new sqr_matrix<T>(this->dimension());
+            std::fill(product, product + N * N, (T) 0);
+            multiplyAdd(N, N, N, (T) 1, term(chain[k].one), N, term(chain[k].two), N, product, N);
         }
 
-        unsigned int i = 0;
-        unsigned int current_exp = 1;
-        unsigned int prev_exp;
+        // The last buffer becomes the result, through a 1 x 1 placeholder
+        sqr_matrix<T> result(1);
+        sqr_matrix<T> &power = storage[buffer.back()];
+        std::swap(result.m_matrix, power.m_matrix);
+        std::swap(result.m_rows, power.m_rows);
+        std::swap(result.m_columns, power.m_columns);
+        return result;
+    }
 
-        *(p[0]) = *this;
+    /*  Returns the matrix to the power of the argument modulo the prime
+     *  1 < p < 2^32, with entries in [0, p), so T must hold p - 1. The
+     *  scalars are reduced first, negative ones included, and every
+     *  product is reduced as well, so nothing overflows whatever the
+     *  exponent: the power follows the addition chain of pow, with the
+     *  multiplications done by multiplyAddMod (head to modular.h).
+     *  The power 0 is the identity.
+     */
+    template <typename T>
+    sqr_matrix<T> sqr_matrix<T>::powMod(unsigned long long exp, residue_t p) const {
+        static_assert(std::is_integral<T>::value, "powMod requires a matrix of integers");
 
-        while (current_exp <= exp) {
-            ++i;
-            current_exp = current_exp << 1;
-            *(p[i]) = *(p[i - 1]) * *(p[i - 1]);
+        if (p < 2 || p > 0xFFFFFFFFULL) {
+            std::cerr << "Error: modulus of matrix power must be in [2, 2^32)" << std::endl;
+            return sqr_matrix<T>(1);
+        }
+        dimension_t N = this->dimension();
+        sqr_matrix<T> result(N, exp == 0);
+
+        if (exp == 0)
+            return result;
+
+        std::vector<chain_step> chain = additionChain(exp);
+        int count;
+        std::vector<int> buffer = assignBuffers(chain, &count);
+        std::vector<packed_residue_t> base((std::size_t) (N * N));
+        std::vector<std::vector<packed_residue_t>> buffers((std::size_t) count,
+                                                           std::vector<packed_residue_t>((std::size_t) (N * N)));
+        std::vector<residue_t> accumulator((std::size_t) (N * N));
+
+        for (dimension_t i = 0; i < N * N; ++i) {
+            if constexpr (std::is_signed<T>::value) {
+                base[i] = (packed_residue_t) reduceMod((long long) this->m_matrix[i], p);
+            } else {
+                base[i] = (packed_residue_t) ((residue_t) this->m_matrix[i] % p);
+            }
         }
 
-        current_exp = current_exp >> 1;
-        prev_exp = current_exp >> 1;
+        // Residues of term k, term 0 being the matrix itself
+        auto term = [&](int k) { return k == 0 ? base.data() : buffers[buffer[k]].data(); };
 
-        *(p[i]) = *(p[i - 1]);
+        for (std::size_t k = 0; k < chain.size(); ++k) {
+            std::fill(accumulator.begin(), accumulator.end(), 0);
+            multiplyAddMod(N, N, N, term(chain[k].one), N, term(chain[k].two), N, accumulator.data(), N, p);
 
-        while (current_exp < exp) {
-            if (prev_exp + current_exp <= exp) {
-                *(p[i]) = *(p[i]) * *(p[(int) log2(prev_exp)]);
-                current_exp += prev_exp;
+            packed_residue_t *product = term((int) k + 1);
+            for (dimension_t i = 0; i < N * N; ++i) {
+                product[i] = (packed_residue_t) accumulator[i];
             }
-            prev_exp = prev_exp >> 1;
         }
 
-        sqr_matrix<T> result = *(p[i]);
+        const packed_residue_t *power = chain.empty() ? base.data() : buffers[buffer.back()].data();
+        for (dimension_t i = 0; i < N * N; ++i) {
+            result.m_matrix[i] = (T) power[i];
+        }
+        return result;
+    }
 
-        for (std::size_t k = 0; k < len; ++k) {
-            delete p[k];
+    /*  Function implementing PA = LU decomposition for the given Matrix,
+     *  with partial pivoting. The scalars are copied into LU and factorized
+     *  in place, so L (unit diagonal implied) and U share that one buffer.
+     *  perm must hold N entries and receives the row interchanges, head
+     *  to lu.h for their format and for the available engines.
+     *  Returns the sign of the permutation P.
+     */
+    template <typename T>
+    int sqr_matrix<T>::decomposeLU(sqr_matrix<double> &LU, dimension_t *perm, lu_engine engine) const {
+        if (LU.dimension() != this->dimension()) {
+            LU = sqr_matrix<double>(this->dimension());
         }
-        delete[] p;
+        double *lu = LU[0];
+        dimension_t total = this->m_rows * this->m_columns;
 
-        return result;
+        for (dimension_t i = 0; i < total; ++i) {
+            lu[i] = (double) this->m_matrix[i];
+        }
+        return factorSquareLU(lu, this->dimension(), this->dimension(), perm, engine);
     }
 
-    // Function implementing PA = LU decomposition for the given Matrix
-    template <typename T>
-    void sqr_matrix<T>::decomposeLU(sqr_matrix<double> &L, sqr_matrix<double> &U) const {
-        for (dimension_t j = 0; j < this->dimension(); j++) {
-            for (dimension_t i = 0; i < this->dimension(); i++) {
-                if (i <= j) {
-                    U[i][j] = (double) (*this)[i][j];
-                    for (dimension_t k = 0; k < i; k++) {
-                        U[i][j] -= L[i][k] * U[k][j];
-                    }
-                    if (i == j)
-                        L[i][j] = 1;
-                    else
-                        L[i][j] = 0;
-                } else {
-                    L[i][j] = (double) (*this)[i][j];
-                    for (dimension_t k = 0; k <= j - 1; k++) {
-                        L[i][j] -= L[i][k] * U[k][j];
-                    }
-                    /*  The following code causes a division-by-zero issue, the results are:
-                     *      - Some scalars are assigned NaN values
-                     *      - Wrong calculation of determinant
-                     *  Run the code to see for yourself
-                     */
-                    L[i][j] /= U[j][j];
-                    U[i][j] = 0;
-                }
+    // Same as above, with the two factors split into packed triangular matrices
+    template <typename T>
+    int sqr_matrix<T>::decomposeLU(lower_triangular<double> &L, upper_triangular<double> &U, dimension_t *perm,
+                                   lu_engine engine) const {
+        sqr_matrix<double> LU(this->dimension());
+        int sign = this->decomposeLU(LU, perm, engine);
+
+        if (L.dimension() != this->dimension()) {
+            L = lower_triangular<double>(this->dimension());
+        }
+        if (U.dimension() != this->dimension()) {
+            U = upper_triangular<double>(this->dimension());
+        }
+        for (dimension_t i = 0; i < this->dimension(); ++i) {
+            for (dimension_t j = 0; j < i; ++j) {
+                L[i][j] = LU[i][j];
+            }
+            L[i][i] = 1;
+            for (dimension_t j = i; j < this->dimension(); ++j) {
+                U[i][j] = LU[i][j];
             }
         }
+        return sign;
     }
 
-    // Returns the determinant of a square matrix
+    /*  Returns the determinant of a square matrix. The pivots are multiplied
+     *  in scaled form, so the result overflows only if the determinant itself
+     *  is out of the range of double, use scaledDeterminant() or slogdet() then.
+     */
     template <typename T>
-    double sqr_matrix<T>::determinant() const {
-        sqr_matrix<double> L(this->dimension());
-        sqr_matrix<double> U(this->dimension());
+    double sqr_matrix<T>::determinant(lu_engine engine) const {
+        scaled_determinant det = this->scaledDeterminant(engine);
+        return std::ldexp(det.mantissa, (int) det.exponent);
+    }
 
-        this->decomposeLU(L, U);
+    /*  Returns the determinant as mantissa * 2^exponent, valid for any N.
+     *  Matrices flagged positive-definite go through Cholesky, unless an
+     *  engine is requested, lu_engine::fast gives the sub-cubic determinant.
+     */
+    template <typename T>
+    scaled_determinant sqr_matrix<T>::scaledDeterminant(lu_engine engine) const {
+        if (m_positive_definite && engine == lu_engine::automatic) {
+            sqr_matrix<double> R(this->dimension());
+            double *r = R[0];
+            dimension_t total = this->m_rows * this->m_columns;
 
-        double detU = 1;
+            for (dimension_t i = 0; i < total; ++i) {
+                r[i] = (double) this->m_matrix[i];
+            }
+            if (factorCholesky(r, this->dimension(), this->dimension())) {
+                return choleskyDeterminant(r, this->dimension(), this->dimension());
+            }
+        }
+        sqr_matrix<double> LU(this->dimension());
+        auto *perm = new dimension_t[(std::size_t) this->dimension()];
 
-        for (dimension_t i = 0; i < this->dimension(); ++i) {
-            detU *= U[i][i];
+        int sign = this->decomposeLU(LU, perm, engine);
+        delete[] perm;
+
+        return pivotProduct(LU[0], this->dimension(), this->dimension(), sign);
+    }
+
+    // Returns the sign and the natural logarithm of the absolute value of the determinant
+    template <typename T>
+    log_determinant sqr_matrix<T>::slogdet(lu_engine engine) const {
+        return logarithmOf(this->scaledDeterminant(engine));
+    }
+
+    /*  Returns the inverse of a square matrix, by the blocked PA = LU
+     *  factorization, inverted in the same buffer, or sub-cubically with
+     *  lu_engine::fast (head to lu.h). A singular
+     *  matrix is reported, and the 1 x 1 matrix is returned.
+     */
+    template <typename T>
+    sqr_matrix<double> sqr_matrix<T>::inverse(lu_engine engine) const {
+        sqr_matrix<double> inv(this->dimension());
+        double *a = inv[0];
+        dimension_t total = this->m_rows * this->m_columns;
+
+        for (dimension_t i = 0; i < total; ++i) {
+            a[i] = (double) this->m_matrix[i];
+        }
+        if (!invertLU(a, this->dimension(), this->dimension(), engine)) {
+            std::cerr << "Error: cannot invert the matrix, it is singular" << std::endl;
+            return sqr_matrix<double>(1);
+        }
+        return inv;
+    }
+
+    /*  Inverts the matrix in place, without a second N x N buffer (except
+     *  with lu_engine::fast), so it requires floating point scalars.
+     *  Returns false if the matrix is singular, in which case an error is
+     *  reported and the matrix is left holding its LU factors.
+     */
+    template <typename T>
+    bool sqr_matrix<T>::invert(lu_engine engine) {
+        static_assert(std::is_floating_point<T>::value, "In-place inversion requires floating point scalars");
+
+        if (!invertLU(this->m_matrix, this->dimension(), this->dimension(), engine)) {
+            std::cerr << "Error: cannot invert the matrix, it is singular" << std::endl;
+            return false;
         }
-        return detU;
+        return true;
     }
 
     // --- OPERATORS ---
@@ -479,6 +627,7 @@ namespace algebra {
             for (dimension_t i = 0; i < total; ++i) {
                 this->m_matrix[i] = arg.m_matrix[i];
             }
+            m_positive_definite = arg.m_positive_definite;
         }
         return *this;
     }
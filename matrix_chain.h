@@ -0,0 +1,156 @@
+#ifndef MATRIX_CHAIN_H
+#define MATRIX_CHAIN_H
+
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "matrix.h"
+#include "kernels.h"    // GEMM kernel
+#include "parallel.h"   // Task graph scheduler for the independent products
+
+
+/*                  MATRIX CHAIN MULTIPLICATION
+ *
+ *  The product A1 A2 ... An is the same for every parenthesization, but
+ *  not its cost: a p x q times q x r product takes p q r multiply-adds,
+ *  so for rectangular factors the left to right order can be many times
+ *  slower than the best one. multiplyChain finds the best order by the
+ *  classic dynamic programming over the dimensions, in O(n^3) for n
+ *  factors, where cost(i, j) is the cheapest way to compute Ai ... Aj:
+ *      cost(i, j) = min over i <= k < j of
+ *                   cost(i, k) + cost(k + 1, j) + rows(Ai) cols(Ak) cols(Aj)
+ *
+ *  The chosen order is a binary tree of products, whose independent
+ *  subtrees are computed concurrently by the task graph of parallel.h,
+ *  every product waiting only for its two operands. The factors are read
+ *  in place, and every intermediate product is released as soon as the
+ *  product using it is done.
+ */
+
+namespace algebra {
+    struct chain_order {
+        std::vector<std::size_t> split;     // split[i * n + j]: the product Ai ... Aj is (Ai ... Ak)(Ak+1 ... Aj)
+        double cost;                        // Multiply-adds of the whole chain
+    };
+
+    chain_order optimalChainOrder(const std::vector<dimension_t> &);
+    template <typename T> matrix<T> multiplyChain(const std::vector<const matrix<T> *> &, unsigned int threads = 0);
+    template <typename T> matrix<T> multiplyChain(std::initializer_list<const matrix<T> *>, unsigned int threads = 0);
+
+
+    // --- BLUEPRINTS ---
+
+    /*  Returns the cheapest parenthesization of a chain of n matrices, the
+     *  i-th one being dimensions[i] x dimensions[i + 1].
+     */
+    inline chain_order optimalChainOrder(const std::vector<dimension_t> &dimensions) {
+        std::size_t n = dimensions.size() - 1;
+        std::vector<double> cost(n * n, 0.0);
+        chain_order order{std::vector<std::size_t>(n * n, 0), 0.0};
+
+        for (std::size_t length = 2; length <= n; ++length) {
+            for (std::size_t i = 0; i + length <= n; ++i) {
+                std::size_t j = i + length - 1;
+                double best = -1;
+
+                for (std::size_t k = i; k < j; ++k) {
+                    double candidate = cost[i * n + k] + cost[(k + 1) * n + j] +
+                                       (double) dimensions[i] * (double) dimensions[k + 1] * (double) dimensions[j + 1];
+                    if (best < 0 || candidate < best) {
+                        best = candidate;
+                        order.split[i * n + j] = k;
+                    }
+                }
+                cost[i * n + j] = best;
+            }
+        }
+        order.cost = cost[n - 1];
+        return order;
+    }
+
+
+    // --- METHODS ---
+
+    /*  Returns the product of the chain of matrices, in the cheapest order.
+     *  The columns of each factor must match the rows of the next one.
+     */
+    template <typename T>
+    matrix<T> multiplyChain(const std::vector<const matrix<T> *> &factors, unsigned int threads) {
+        std::size_t n = factors.size();
+
+        if (n == 0) {
+            std::cerr << "Error: cannot multiply an empty chain of matrices" << std::endl;
+            return matrix<T>(1, 1);
+        }
+        std::vector<dimension_t> dimensions(1, factors[0]->numOfRows());
+        for (std::size_t i = 0; i < n; ++i) {
+            if (factors[i]->numOfRows() != dimensions.back()) {
+                std::cerr << "Error: cannot multiply matrices\n"
+                          << "Columns and rows of instances do not match"
+                          << std::endl;
+                return matrix<T>(1, 1);
+            }
+            dimensions.push_back(factors[i]->numOfCols());
+        }
+        if (n == 1)
+            return *factors[0];
+
+        chain_order order = optimalChainOrder(dimensions);
+
+        // The product Ai ... Aj of every node of the tree, each one written by its own task only
+        std::vector<std::unique_ptr<matrix<T>>> products(n * n);
+        task_graph graph;
+
+        auto operand = [&](std::size_t i, std::size_t j) -> const matrix<T> & {
+            return i == j ? *factors[i] : *products[i * n + j];
+        };
+
+        // Adds the tasks of the subtree Ai ... Aj, returns the task of its root
+        std::function<task_graph::task_t(std::size_t, std::size_t, int)> schedule;
+        schedule = [&](std::size_t i, std::size_t j, int depth) -> task_graph::task_t {
+            std::size_t k = order.split[i * n + j];
+
+            task_graph::task_t task = graph.addTask([&, i, j, k]() {
+                const matrix<T> &left = operand(i, k);
+                const matrix<T> &right = operand(k + 1, j);
+
+                products[i * n + j].reset(new matrix<T>(dimensions[i], dimensions[j + 1]));
+                matrix<T> &product = *products[i * n + j];
+
+                product.init((T) 0);
+                multiplyAdd(left.numOfRows(), right.numOfCols(), left.numOfCols(), (T) 1,
+                            left[0], left.numOfCols(), right[0], right.numOfCols(), product[0], product.numOfCols());
+
+                // The operands are not needed anymore, only this node reads them
+                if (i < k)
+                    products[i * n + k].reset();
+                if (k + 1 < j)
+                    products[(k + 1) * n + j].reset();
+            }, depth);
+
+            // Deeper products first, they hold back the longest paths
+            if (i < k)
+                graph.addDependency(schedule(i, k, depth + 1), task);
+            if (k + 1 < j)
+                graph.addDependency(schedule(k + 1, j, depth + 1), task);
+            return task;
+        };
+
+        schedule(0, n - 1, 0);
+        graph.run(threads);
+
+        return *products[n - 1];
+    }
+
+    // Same as above, for multiplyChain({&A, &B, &C, ...})
+    template <typename T>
+    matrix<T> multiplyChain(std::initializer_list<const matrix<T> *> factors, unsigned int threads) {
+        return multiplyChain(std::vector<const matrix<T> *>(factors), threads);
+    }
+}
+
+
+#endif // MATRIX_CHAIN_H
@@ -0,0 +1,278 @@
+#ifndef MATRIX_FUNCTIONS_H
+#define MATRIX_FUNCTIONS_H
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "matrix.h"
+#include "kernels.h"    // GEMM kernel and the magnitude of scalars
+#include "lu.h"         // LU kernels, for the Pade denominator
+
+
+/*                      MATRIX FUNCTIONS
+ *
+ *  Polynomials and the exponential of square matrices of real or complex
+ *  scalars, by as few matrix multiplications as possible, since those are
+ *  the only O(n^3) steps.
+ *
+ *  polyval evaluates p(A) = c0 I + c1 A + ... + cd A^d by the
+ *  Paterson-Stockmeyer scheme: with A^2 ... A^s precomputed, p is split
+ *  into blocks of s coefficients, each one a linear combination of those
+ *  powers, and the blocks are combined by Horner's rule in A^s. That is
+ *  about 2 sqrt(d) multiplications instead of the d - 1 of Horner's rule
+ *  (or the d log d of summing powers through pow), s being chosen per
+ *  degree as the cheapest.
+ *
+ *  expm computes e^A by the scaling and squaring method with Pade
+ *  approximants (Higham, 2005): the [m/m] approximant r_m(A) = q(A)^-1 p(A)
+ *  of degree 3, 5, 7, 9 or 13 is the lowest one accurate to double
+ *  precision for ||A||_1, past degree 13 the matrix is scaled by 2^-s
+ *  first and the result squared s times. Its cost is 6 multiplications
+ *  and one linear solve for the degree 13, with the odd and even parts of
+ *  p evaluated together, where a truncated Taylor series needs about
+ *  twice as many terms for the same accuracy.
+ *
+ *  The scalars must be double or complex (float is accepted but the
+ *  degrees are tuned to double).
+ */
+
+namespace algebra {
+    template <typename T> sqr_matrix<T> polyval(const sqr_matrix<T> &, const std::vector<T> &);
+    template <typename T> sqr_matrix<T> expm(const sqr_matrix<T> &);
+
+
+    // --- BLUEPRINTS ---
+
+    // C = A * B, of N x N contiguous matrices, C apart from both
+    template <typename T>
+    void multiplySquare(dimension_t N, const T *A, const T *B, T *C) {
+        std::fill(C, C + N * N, (T) 0);
+        multiplyAdd(N, N, N, (T) 1, A, N, B, N, C, N);
+    }
+
+    // C += alpha * A, of N x N contiguous matrices, A = nullptr standing for the identity
+    template <typename T>
+    void addScaled(dimension_t N, T alpha, const T *A, T *C) {
+        if (A == nullptr) {
+            for (dimension_t i = 0; i < N; ++i) {
+                C[i * N + i] += alpha;
+            }
+            return;
+        }
+        updateRow(N * N, alpha, A, C);
+    }
+
+    // Returns the 1-norm, the largest sum of magnitudes over the columns
+    template <typename T>
+    double normOne(dimension_t N, const T *A) {
+        std::vector<double> sums((std::size_t) N, 0.0);
+
+        for (dimension_t i = 0; i < N; ++i) {
+            for (dimension_t j = 0; j < N; ++j) {
+                sums[j] += magnitude(A[i * N + j]);
+            }
+        }
+        return N == 0 ? 0.0 : *std::max_element(sums.begin(), sums.end());
+    }
+
+    // Returns the number of multiplications of Paterson-Stockmeyer for degree d with powers up to s
+    inline dimension_t patersonStockmeyerCost(dimension_t d, dimension_t s) {
+        // The top block is c_d I alone when s divides d, its Horner step is a scaling then
+        return (s - 1) + d / s - (d % s == 0 ? 1 : 0);
+    }
+
+    /*  X = (q(A))^-1 p(A) for p = V + U and q = V - U, in place of U and V
+     *  (X is returned in V), returns false if q(A) is singular.
+     */
+    template <typename T>
+    bool solvePade(dimension_t N, T *U, T *V) {
+        std::vector<dimension_t> perm((std::size_t) N);
+
+        for (dimension_t i = 0; i < N * N; ++i) {
+            T sum = V[i] + U[i];
+            U[i] = V[i] - U[i];
+            V[i] = sum;
+        }
+        factorSquareLU(U, N, N, perm.data());
+        for (dimension_t i = 0; i < N; ++i) {
+            if (magnitude(U[i * N + i]) == 0)
+                return false;
+        }
+        swapRows(V, N, 0, N, perm.data(), 0, N);
+        solveUnitLower(N, N, U, N, V, N);
+        solveUpper(N, N, U, N, V, N);
+        return true;
+    }
+
+
+    // --- METHODS ---
+
+    /*  Returns c0 I + c1 A + ... + cd A^d, the coefficients given from the
+     *  lowest degree, by the Paterson-Stockmeyer scheme.
+     */
+    template <typename T>
+    sqr_matrix<T> polyval(const sqr_matrix<T> &A, const std::vector<T> &coefficients) {
+        dimension_t N = A.dimension();
+        sqr_matrix<T> result(N);
+
+        result.init((T) 0);
+        if (coefficients.empty())
+            return result;
+
+        dimension_t d = (dimension_t) coefficients.size() - 1;
+        dimension_t s = 1;
+        for (dimension_t candidate = 2; candidate * candidate <= 4 * d; ++candidate) {
+            if (patersonStockmeyerCost(d, candidate) < patersonStockmeyerCost(d, s))
+                s = candidate;
+        }
+
+        // powers[i] = A^i, for i = 1 ... s
+        std::vector<std::vector<T>> powers((std::size_t) (s + 1));
+        powers[1].assign(A[0], A[0] + N * N);
+        for (dimension_t i = 2; i <= s; ++i) {
+            powers[i].resize((std::size_t) (N * N));
+            multiplySquare(N, powers[i - 1].data(), A[0], powers[i].data());
+        }
+
+        // out += block j, the sum of c_(js + i) A^i over i < s
+        auto addBlock = [&](dimension_t j, T *out) {
+            for (dimension_t i = 0; i < s && j * s + i <= d; ++i) {
+                addScaled(N, coefficients[j * s + i], i == 0 ? nullptr : powers[i].data(), out);
+            }
+        };
+
+        std::vector<T> current((std::size_t) (N * N), (T) 0);
+        std::vector<T> next((std::size_t) (N * N));
+        dimension_t top = d / s;
+        dimension_t j = top;
+
+        if (d % s == 0 && top > 0) {
+            // The top block is c_d I: current = c_d A^s + block (top - 1)
+            addScaled(N, coefficients[d], powers[s].data(), current.data());
+            addBlock(--j, current.data());
+        } else {
+            addBlock(j, current.data());
+        }
+        while (j > 0) {
+            multiplySquare(N, current.data(), powers[s].data(), next.data());
+            addBlock(--j, next.data());
+            current.swap(next);
+        }
+
+        std::copy(current.begin(), current.end(), result[0]);
+        return result;
+    }
+
+    /*  Returns e^A, by scaling and squaring with the Pade approximant of
+     *  the lowest sufficient degree. On a singular denominator, which the
+     *  degree bounds rule out in exact arithmetic, a 1 x 1 matrix is
+     *  returned.
+     */
+    template <typename T>
+    sqr_matrix<T> expm(const sqr_matrix<T> &A) {
+        // Coefficients of the numerators, and the norms up to which each degree is accurate
+        static const double b3[] = {120, 60, 12, 1};
+        static const double b5[] = {30240, 15120, 3360, 420, 30, 1};
+        static const double b7[] = {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1};
+        static const double b9[] = {17643225600, 8821612800, 2075673600, 302702400, 30270240, 2162160, 110880,
+                                    3960, 90, 1};
+        static const double b13[] = {64764752532480000, 32382376266240000, 7771770303897600, 1187353796428800,
+                                     129060195264000, 10559470521600, 670442572800, 33522128640, 1323241920,
+                                     40840800, 960960, 16380, 182, 1};
+        static const double theta[] = {1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+                                       2.097847961257068e0, 5.371920351148152e0};
+        static const double *low[] = {b3, b5, b7, b9};
+
+        dimension_t N = A.dimension();
+        std::size_t size = (std::size_t) (N * N);
+        std::vector<T> a(A[0], A[0] + N * N);
+        std::vector<T> U(size, (T) 0), V(size, (T) 0);
+        std::vector<T> A2(size), A4(size), A6(size);
+        double norm = normOne(N, a.data());
+        int squarings = 0;
+
+        multiplySquare(N, a.data(), a.data(), A2.data());
+
+        int degree = 0;
+        while (degree < 4 && norm > theta[degree])
+            ++degree;
+
+        if (degree < 4) {
+            // U = A (b1 I + b3 A^2 + ...), V = b0 I + b2 A^2 + ..., up to A^(m - 1)
+            const double *b = low[degree];
+            int m = 2 * degree + 3;
+            std::vector<T> odd(size, (T) 0);
+            std::vector<T> power = A2;
+            std::vector<T> scratch(size);
+
+            addScaled(N, (T) b[1], (const T *) nullptr, odd.data());
+            addScaled(N, (T) b[0], (const T *) nullptr, V.data());
+            for (int k = 2; k < m; k += 2) {
+                if (k > 2) {
+                    multiplySquare(N, power.data(), A2.data(), scratch.data());
+                    power.swap(scratch);
+                }
+                addScaled(N, (T) b[k + 1], power.data(), odd.data());
+                addScaled(N, (T) b[k], power.data(), V.data());
+            }
+            multiplySquare(N, a.data(), odd.data(), U.data());
+        } else {
+            if (norm > theta[4]) {
+                squarings = (int) std::ceil(std::log2(norm / theta[4]));
+                T scale = (T) std::ldexp(1.0, -squarings);
+                T scale2 = scale * scale;
+                for (std::size_t i = 0; i < size; ++i) {
+                    a[i] = a[i] * scale;
+                    A2[i] = A2[i] * scale2;
+                }
+            }
+            multiplySquare(N, A2.data(), A2.data(), A4.data());
+            multiplySquare(N, A4.data(), A2.data(), A6.data());
+
+            // U = A [A6 (b13 A6 + b11 A4 + b9 A2) + b7 A6 + b5 A4 + b3 A2 + b1 I]
+            std::vector<T> inner(size, (T) 0);
+            std::vector<T> outer(size);
+
+            addScaled(N, (T) b13[13], A6.data(), inner.data());
+            addScaled(N, (T) b13[11], A4.data(), inner.data());
+            addScaled(N, (T) b13[9], A2.data(), inner.data());
+            multiplySquare(N, A6.data(), inner.data(), outer.data());
+            addScaled(N, (T) b13[7], A6.data(), outer.data());
+            addScaled(N, (T) b13[5], A4.data(), outer.data());
+            addScaled(N, (T) b13[3], A2.data(), outer.data());
+            addScaled(N, (T) b13[1], (const T *) nullptr, outer.data());
+            multiplySquare(N, a.data(), outer.data(), U.data());
+
+            // V = A6 (b12 A6 + b10 A4 + b8 A2) + b6 A6 + b4 A4 + b2 A2 + b0 I
+            std::fill(inner.begin(), inner.end(), (T) 0);
+            addScaled(N, (T) b13[12], A6.data(), inner.data());
+            addScaled(N, (T) b13[10], A4.data(), inner.data());
+            addScaled(N, (T) b13[8], A2.data(), inner.data());
+            multiplySquare(N, A6.data(), inner.data(), V.data());
+            addScaled(N, (T) b13[6], A6.data(), V.data());
+            addScaled(N, (T) b13[4], A4.data(), V.data());
+            addScaled(N, (T) b13[2], A2.data(), V.data());
+            addScaled(N, (T) b13[0], (const T *) nullptr, V.data());
+        }
+
+        if (!solvePade(N, U.data(), V.data())) {
+            std::cerr << "Error: cannot compute the exponential, the Pade denominator is singular" << std::endl;
+            return sqr_matrix<T>(1);
+        }
+
+        // e^A = (r(A / 2^s))^(2^s), U as the scratch buffer
+        for (int k = 0; k < squarings; ++k) {
+            multiplySquare(N, V.data(), V.data(), U.data());
+            V.swap(U);
+        }
+
+        sqr_matrix<T> result(N);
+        std::copy(V.begin(), V.end(), result[0]);
+        return result;
+    }
+}
+
+
+#endif // MATRIX_FUNCTIONS_H
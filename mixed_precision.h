@@ -0,0 +1,270 @@
+#ifndef MIXED_PRECISION_H
+#define MIXED_PRECISION_H
+
+#include <iostream>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+
+#include "matrix.h"
+#include "lu_factorization.h"   // Double precision fallback
+
+
+/*              MIXED PRECISION LU FACTORIZATION CLASS
+ *
+ *  Factorizes a square matrix in single precision, with half the memory
+ *  traffic and twice the SIMD width of double, and recovers double
+ *  accuracy for linear systems by iterative refinement (as LAPACK's
+ *  dsgesv): the residual r = b - A x is computed in double against the
+ *  original matrix, the correction is solved with the float factors,
+ *  and x += d, until
+ *      ||r|| <= ||x|| * ||A|| * DBL_EPSILON * sqrt(N)    (infinity norms)
+ *  holds for every column. Refinement converges when the condition
+ *  number of the matrix is well below 1 / FLT_EPSILON (about 1e7); past
+ *  REFINEMENT_MAX_ITERATIONS steps, or if the matrix does not fit in
+ *  float, solve() reports the failure, solveMixedPrecision() then falls
+ *  back to a double factorization on its own.
+ *
+ *  The matrix is copied in double, which the residuals need anyway, so
+ *  the argument may be a temporary. Iterative refinement does not apply
+ *  to the determinant, which comes from the float factors and is only
+ *  accurate to single precision, about N * FLT_EPSILON relative for well
+ *  conditioned matrices.
+ */
+
+namespace algebra {
+    const int REFINEMENT_MAX_ITERATIONS = 30;  // Refinement steps before giving up
+
+    // Outcome of an iterative refinement
+    struct refinement_report {
+        bool converged;
+        int iterations;         // Correction steps performed
+        double backward_error;  // Largest ||r|| / (||A|| * ||x||) over the columns, in the infinity norm
+        bool fallback;          // Whether a double factorization was used instead
+    };
+
+    template <class T>
+    class mixed_lu_factorization
+    {
+    protected:    // Class members
+        sqr_matrix<double> m_matrix;                 // The matrix in double, for the residuals
+        mutable sqr_matrix<float> m_lu;              // The float factors, head to lu.h for their format
+        mutable std::vector<dimension_t> m_perm;
+        mutable int m_sign;
+        mutable bool m_factorized;
+        mutable bool m_representable;                // Whether the matrix fits in float and the factors are regular
+        mutable double m_norm;                       // Infinity norm of the matrix
+        lu_engine m_engine;
+
+    protected:
+        void solveFloat(const matrix<double> &, matrix<double> &) const;
+        void residual(const matrix<double> &, const matrix<double> &, matrix<double> &) const;
+
+    public: // Constructors
+        mixed_lu_factorization() = delete;
+        explicit mixed_lu_factorization(const sqr_matrix<T> &, lu_engine engine = lu_engine::automatic);
+
+    public: // Methods
+        void factorize() const;
+        bool isFactorized() const { return m_factorized; }
+        dimension_t dimension() const { return m_matrix.dimension(); }
+
+        double determinant() const;
+        scaled_determinant scaledDeterminant() const;
+        log_determinant slogdet() const;
+        matrix<double> solve(const matrix<double> &, refinement_report *report = nullptr) const;
+    };
+
+    template <typename T> matrix<double> solveMixedPrecision(const sqr_matrix<T> &, const matrix<double> &,
+                                                             refinement_report *report = nullptr);
+
+
+    // --- BLUEPRINTS ---
+
+    // Explicit Constructor, copies the matrix in double without factorizing it
+    template <typename T>
+    mixed_lu_factorization<T>::mixed_lu_factorization(const sqr_matrix<T> &arg, lu_engine engine)
+            : m_matrix(arg.dimension()), m_lu(arg.dimension()), m_perm((std::size_t) arg.dimension()), m_sign(1),
+              m_factorized(false), m_representable(true), m_norm(0), m_engine(engine) {
+        for (dimension_t i = 0; i < arg.dimension(); ++i) {
+            for (dimension_t j = 0; j < arg.dimension(); ++j) {
+                m_matrix[i][j] = (double) arg[i][j];
+            }
+        }
+    }
+
+
+    // --- METHODS ---
+
+    // Rounds the matrix to float and factorizes it, if not already done
+    template <typename T>
+    void mixed_lu_factorization<T>::factorize() const {
+        if (m_factorized)
+            return;
+
+        dimension_t N = dimension();
+        for (dimension_t i = 0; i < N; ++i) {
+            double row_sum = 0;
+            for (dimension_t j = 0; j < N; ++j) {
+                double scalar = m_matrix[i][j];
+                if (std::abs(scalar) > FLT_MAX)
+                    m_representable = false;
+
+                m_lu[i][j] = (float) scalar;
+                row_sum += std::abs(scalar);
+            }
+            if (row_sum > m_norm)
+                m_norm = row_sum;
+        }
+
+        m_sign = factorSquareLU(m_lu[0], N, N, m_perm.data(), m_engine);
+        for (dimension_t i = 0; i < N; ++i) {
+            if (m_lu[i][i] == 0.0f || !std::isfinite(m_lu[i][i]))
+                m_representable = false;
+        }
+        m_factorized = true;
+    }
+
+    // X = A^-1 B with the float factors, B and X in double
+    template <typename T>
+    void mixed_lu_factorization<T>::solveFloat(const matrix<double> &B, matrix<double> &X) const {
+        dimension_t N = dimension();
+        dimension_t columns = B.numOfCols();
+        std::vector<float> buffer((std::size_t) (N * columns));
+
+        for (dimension_t i = 0; i < N; ++i) {
+            for (dimension_t j = 0; j < columns; ++j) {
+                buffer[i * columns + j] = (float) B[i][j];
+            }
+        }
+        swapRows(buffer.data(), columns, 0, columns, m_perm.data(), 0, N);
+        solveUnitLower(N, columns, m_lu[0], N, buffer.data(), columns);
+        solveUpper(N, columns, m_lu[0], N, buffer.data(), columns);
+
+        for (dimension_t i = 0; i < N; ++i) {
+            for (dimension_t j = 0; j < columns; ++j) {
+                X[i][j] = (double) buffer[i * columns + j];
+            }
+        }
+    }
+
+    // R = B - A X, in double
+    template <typename T>
+    void mixed_lu_factorization<T>::residual(const matrix<double> &B, const matrix<double> &X, matrix<double> &R) const {
+        dimension_t N = dimension();
+        dimension_t columns = B.numOfCols();
+
+        R = B;
+        multiplyAdd(N, columns, N, -1.0, m_matrix[0], N, X[0], columns, R[0], columns);
+    }
+
+    // Returns the determinant of the matrix, to single precision
+    template <typename T>
+    double mixed_lu_factorization<T>::determinant() const {
+        scaled_determinant det = scaledDeterminant();
+        return std::ldexp(det.mantissa, (int) det.exponent);
+    }
+
+    // Returns the determinant as mantissa * 2^exponent, to single precision
+    template <typename T>
+    scaled_determinant mixed_lu_factorization<T>::scaledDeterminant() const {
+        factorize();
+        return pivotProduct(m_lu[0], dimension(), dimension(), m_sign);
+    }
+
+    // Returns the sign and the natural logarithm of the absolute value of the determinant, to single precision
+    template <typename T>
+    log_determinant mixed_lu_factorization<T>::slogdet() const {
+        return logarithmOf(scaledDeterminant());
+    }
+
+    /*  Returns X, the solution of A X = B, refined to double accuracy.
+     *  If the refinement fails, the last iterate is returned and the report
+     *  (if given) tells so, a double factorization is needed then.
+     */
+    template <typename T>
+    matrix<double> mixed_lu_factorization<T>::solve(const matrix<double> &B, refinement_report *report) const {
+        refinement_report outcome = {false, 0, INFINITY, false};
+        dimension_t N = dimension();
+        dimension_t columns = B.numOfCols();
+
+        if (B.numOfRows() != N) {
+            std::cerr << "Error: cannot solve the linear system\n"
+                      << "Rows of the right-hand side do not match the matrix"
+                      << std::endl;
+            if (report != nullptr) {
+                *report = outcome;
+            }
+            return matrix<double>(1, 1);
+        }
+        factorize();
+
+        matrix<double> X(N, columns);
+        matrix<double> R(N, columns);
+        matrix<double> D(N, columns);
+
+        X.init(0.0);
+        if (m_representable) {
+            solveFloat(B, X);
+
+            while (true) {
+                residual(B, X, R);
+
+                // Convergence test, column by column
+                outcome.converged = true;
+                outcome.backward_error = 0;
+                for (dimension_t j = 0; j < columns; ++j) {
+                    double r_norm = 0;
+                    double x_norm = 0;
+                    for (dimension_t i = 0; i < N; ++i) {
+                        r_norm = std::fmax(r_norm, std::abs(R[i][j]));
+                        x_norm = std::fmax(x_norm, std::abs(X[i][j]));
+                    }
+                    if (!(r_norm <= x_norm * m_norm * DBL_EPSILON * std::sqrt((double) N)))
+                        outcome.converged = false;
+                    if (r_norm > 0)
+                        outcome.backward_error = std::fmax(outcome.backward_error, r_norm / (m_norm * x_norm));
+                }
+                if (outcome.converged || outcome.iterations == REFINEMENT_MAX_ITERATIONS)
+                    break;
+
+                solveFloat(R, D);
+                for (dimension_t i = 0; i < N; ++i) {
+                    for (dimension_t j = 0; j < columns; ++j) {
+                        X[i][j] += D[i][j];
+                    }
+                }
+                ++outcome.iterations;
+            }
+        }
+
+        if (report != nullptr) {
+            *report = outcome;
+        }
+        return X;
+    }
+
+    /*  Returns X, the solution of A X = B, by a one-off mixed precision
+     *  factorization of A, falling back to a double one if the refinement
+     *  fails to converge.
+     */
+    template <typename T>
+    matrix<double> solveMixedPrecision(const sqr_matrix<T> &A, const matrix<double> &B, refinement_report *report) {
+        mixed_lu_factorization<T> mixed(A);
+        refinement_report outcome = {false, 0, INFINITY, false};
+        matrix<double> X = mixed.solve(B, &outcome);
+
+        if (!outcome.converged && B.numOfRows() == A.dimension()) {
+            lu_factorization<T> lu(A);
+            X = lu.solve(B);
+            outcome.fallback = true;
+        }
+        if (report != nullptr) {
+            *report = outcome;
+        }
+        return X;
+    }
+}
+
+
+#endif // MIXED_PRECISION_H
@@ -0,0 +1,203 @@
+#ifndef MODULAR_H
+#define MODULAR_H
+
+
+/*                     MODULAR ARITHMETIC
+ *
+ *  Arithmetic modulo word-size primes, for the exact algorithms on
+ *  integer matrices. Every modulus is below 2^32, so the product of
+ *  two residues always fits in an unsigned long long.
+ *
+ *  The matrix product modulo p reduces lazily: products of residues are
+ *  summed in 64 bits as long as the sum cannot overflow, which is 16
+ *  products for p < 2^30 and at least one for any p < 2^32, and only then
+ *  reduced, by Barrett's method (a multiplication by a precomputed
+ *  2^64 / p instead of a division). The factors are stored in 32 bits,
+ *  so the inner loop is a plain widening multiply-add that vectorizes.
+ */
+
+namespace algebra {
+    typedef unsigned long long residue_t;  // data type for residues and moduli
+    typedef unsigned int packed_residue_t; // residues stored in 32 bits, for the matrix kernels
+    typedef long long dimension_t;         // same data type as in matrix.h
+
+    const dimension_t MODULAR_BLOCK_K = 128;   // Rows of the cached block of B
+    const dimension_t MODULAR_BLOCK_N = 512;   // Columns of the cached block of B
+
+    residue_t mulMod(residue_t, residue_t, residue_t);
+    residue_t powMod(residue_t, unsigned long long, residue_t);
+    residue_t inverseMod(residue_t, residue_t);
+    residue_t reduceMod(long long, residue_t);
+    residue_t barrettFactor(residue_t);
+    residue_t reduceBarrett(residue_t, residue_t, residue_t);
+    void multiplyAddMod(dimension_t, dimension_t, dimension_t, const packed_residue_t *, dimension_t,
+                        const packed_residue_t *, dimension_t, residue_t *, dimension_t, residue_t);
+    bool isPrime(residue_t);
+    residue_t previousPrime(residue_t);
+
+
+    // --- BLUEPRINTS ---
+
+    // Returns (a * b) mod p, for a, b < p < 2^32
+    inline residue_t mulMod(residue_t a, residue_t b, residue_t p) {
+        return a * b % p;
+    }
+
+    // Returns (base ^ exp) mod p, by binary exponentiation
+    inline residue_t powMod(residue_t base, unsigned long long exp, residue_t p) {
+        residue_t result = 1 % p;
+        base %= p;
+
+        while (exp > 0) {
+            if (exp & 1)
+                result = mulMod(result, base, p);
+            base = mulMod(base, base, p);
+            exp >>= 1;
+        }
+        return result;
+    }
+
+    // Returns the inverse of a modulo the prime p (Fermat's little theorem), a must not be 0 mod p
+    inline residue_t inverseMod(residue_t a, residue_t p) {
+        return powMod(a, p - 2, p);
+    }
+
+    // Returns the residue of a signed integer, in [0, p)
+    inline residue_t reduceMod(long long a, residue_t p) {
+        long long r = a % (long long) p;
+        return (residue_t) (r < 0 ? r + (long long) p : r);
+    }
+
+    // Returns floor(2^64 / p), the Barrett factor of the modulus 1 < p < 2^32
+    inline residue_t barrettFactor(residue_t p) {
+        return (residue_t) (((unsigned __int128) 1 << 64) / p);
+    }
+
+    // Returns x mod p, any x, with factor = barrettFactor(p): the quotient estimate is short by at most one
+    inline residue_t reduceBarrett(residue_t x, residue_t p, residue_t factor) {
+        residue_t quotient = (residue_t) (((unsigned __int128) x * factor) >> 64);
+        residue_t remainder = x - quotient * p;
+        return remainder >= p ? remainder - p : remainder;
+    }
+
+    // c0 ... c3 += a0 ... a3 * b, over n contiguous residues, in 64 bits without reduction
+    inline void updateRowsMod(dimension_t n, packed_residue_t a0, packed_residue_t a1, packed_residue_t a2,
+                              packed_residue_t a3, const packed_residue_t *__restrict b, residue_t *__restrict c0,
+                              residue_t *__restrict c1, residue_t *__restrict c2, residue_t *__restrict c3) {
+        for (dimension_t j = 0; j < n; ++j) {
+            residue_t scalar = b[j];
+            c0[j] += a0 * scalar;
+            c1[j] += a1 * scalar;
+            c2[j] += a2 * scalar;
+            c3[j] += a3 * scalar;
+        }
+    }
+
+    // c = c mod p, over n contiguous accumulators
+    inline void reduceRow(dimension_t n, residue_t *c, residue_t p, residue_t factor) {
+        for (dimension_t j = 0; j < n; ++j) {
+            c[j] = reduceBarrett(c[j], p, factor);
+        }
+    }
+
+    /*  C = (C + A * B) mod p, where A is M x K, B is K x N, both of residues,
+     *  and C is M x N, of residues on entry and on exit. Tiled as
+     *  multiplyAdd, four rows at a time, with C as the 64-bit accumulator
+     *  of the products.
+     */
+    inline void multiplyAddMod(dimension_t M, dimension_t N, dimension_t K,
+                               const packed_residue_t *A, dimension_t lda, const packed_residue_t *B, dimension_t ldb,
+                               residue_t *C, dimension_t ldc, residue_t p) {
+        residue_t factor = barrettFactor(p);
+        residue_t square = (p - 1) * (p - 1);
+        // Products summed before a reduction, the accumulator starting below p
+        residue_t delay = (~0ULL - (p - 1)) / square;
+
+        for (dimension_t k0 = 0; k0 < K; k0 += MODULAR_BLOCK_K) {
+            dimension_t k1 = k0 + MODULAR_BLOCK_K < K ? k0 + MODULAR_BLOCK_K : K;
+
+            for (dimension_t j0 = 0; j0 < N; j0 += MODULAR_BLOCK_N) {
+                dimension_t n = j0 + MODULAR_BLOCK_N < N ? MODULAR_BLOCK_N : N - j0;
+
+                for (dimension_t i = 0; i < M; i += 4) {
+                    dimension_t rows = i + 4 <= M ? 4 : M - i;
+                    residue_t pending = 0;
+
+                    for (dimension_t k = k0; k < k1; ++k) {
+                        const packed_residue_t *b = B + k * ldb + j0;
+
+                        if (rows == 4) {
+                            updateRowsMod(n, A[i * lda + k], A[(i + 1) * lda + k], A[(i + 2) * lda + k],
+                                          A[(i + 3) * lda + k], b, C + i * ldc + j0, C + (i + 1) * ldc + j0,
+                                          C + (i + 2) * ldc + j0, C + (i + 3) * ldc + j0);
+                        } else {
+                            for (dimension_t r = i; r < M; ++r) {
+                                residue_t a = A[r * lda + k];
+                                residue_t *c = C + r * ldc + j0;
+                                for (dimension_t j = 0; j < n; ++j) {
+                                    c[j] += a * b[j];
+                                }
+                            }
+                        }
+
+                        if (++pending == delay || k + 1 == k1) {
+                            for (dimension_t r = i; r < i + rows; ++r) {
+                                reduceRow(n, C + r * ldc + j0, p, factor);
+                            }
+                            pending = 0;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Deterministic Miller-Rabin test, the bases 2, 7 and 61 make it exact for every n < 2^32
+    inline bool isPrime(residue_t n) {
+        const residue_t small_primes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61};
+        const residue_t bases[] = {2, 7, 61};
+
+        if (n < 2)
+            return false;
+        for (residue_t small : small_primes) {
+            if (n % small == 0)
+                return n == small;
+        }
+
+        residue_t d = n - 1;
+        int s = 0;
+        while ((d & 1) == 0) {
+            d >>= 1;
+            ++s;
+        }
+
+        for (residue_t base : bases) {
+            residue_t x = powMod(base, d, n);
+            if (x == 1 || x == n - 1)
+                continue;
+
+            bool composite = true;
+            for (int r = 1; r < s && composite; ++r) {
+                x = mulMod(x, x, n);
+                if (x == n - 1)
+                    composite = false;
+            }
+            if (composite)
+                return false;
+        }
+        return true;
+    }
+
+    // Returns the largest prime strictly below n, or 0 if there is none
+    inline residue_t previousPrime(residue_t n) {
+        while (n > 2) {
+            --n;
+            if (isPrime(n))
+                return n;
+        }
+        return 0;
+    }
+}
+
+
+#endif // MODULAR_H
@@ -0,0 +1,162 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+/*                       TASK GRAPH CLASS
+ *
+ *  A dependency-driven scheduler for the tiled algorithms. Tasks are
+ *  added together with the tasks they depend upon, and run() executes
+ *  the resulting directed acyclic graph on a pool of threads: a task
+ *  becomes ready as soon as all of its predecessors are finished, so
+ *  there are no global synchronization points between the steps of an
+ *  algorithm. Among the ready tasks, the one with the highest priority
+ *  runs first, which lets the critical path of an algorithm (e.g. the
+ *  panel factorizations of LU) overtake the bulk of the updates.
+ *
+ *  parallelFor covers the simpler case of independent iterations, as a
+ *  graph without dependencies over consecutive chunks of the range.
+ */
+
+namespace algebra {
+    class task_graph
+    {
+    public:
+        typedef std::size_t task_t;     // Handle of a task, in order of addition
+
+    protected:
+        struct node {
+            std::function<void()> work;
+            int priority;
+            std::size_t dependencies;       // Number of unfinished predecessors
+            std::vector<task_t> successors;
+        };
+        std::vector<node> m_tasks;
+
+    public: // Methods
+        task_t addTask(std::function<void()>, int priority = 0);
+        void addDependency(task_t before, task_t after);
+        std::size_t size() const { return m_tasks.size(); }
+        void run(unsigned int threads = 0);
+    };
+
+    unsigned int defaultThreads();
+    template <typename F> void parallelFor(std::size_t, std::size_t, F, unsigned int threads = 0);
+
+
+    // --- BLUEPRINTS ---
+
+    // Number of threads used when none is requested, one per core
+    inline unsigned int defaultThreads() {
+        unsigned int threads = std::thread::hardware_concurrency();
+        return threads == 0 ? 1 : threads;
+    }
+
+    // Adds a task to the graph, returns its handle
+    inline task_graph::task_t task_graph::addTask(std::function<void()> work, int priority) {
+        m_tasks.push_back(node{std::move(work), priority, 0, {}});
+        return m_tasks.size() - 1;
+    }
+
+    // Task "after" will not start before task "before" is finished
+    inline void task_graph::addDependency(task_t before, task_t after) {
+        m_tasks[before].successors.push_back(after);
+        m_tasks[after].dependencies++;
+    }
+
+    /*  Executes every task of the graph and returns when all of them are
+     *  finished. The calling thread takes part in the work, so with one
+     *  thread the graph simply runs sequentially in priority order.
+     *  The graph is consumed, it must be rebuilt to run again.
+     */
+    inline void task_graph::run(unsigned int threads) {
+        if (threads == 0) {
+            threads = defaultThreads();
+        }
+        auto lower_priority = [this](task_t one, task_t two) {
+            return m_tasks[one].priority < m_tasks[two].priority;
+        };
+        std::priority_queue<task_t, std::vector<task_t>, decltype(lower_priority)> ready(lower_priority);
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t finished = 0;
+
+        for (task_t i = 0; i < m_tasks.size(); ++i) {
+            if (m_tasks[i].dependencies == 0)
+                ready.push(i);
+        }
+
+        auto worker = [&]() {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            while (true) {
+                cv.wait(lock, [&]() { return !ready.empty() || finished == m_tasks.size(); });
+                if (ready.empty())
+                    return;
+
+                task_t task = ready.top();
+                ready.pop();
+
+                lock.unlock();
+                m_tasks[task].work();
+                lock.lock();
+
+                for (task_t successor : m_tasks[task].successors) {
+                    if (--m_tasks[successor].dependencies == 0) {
+                        ready.push(successor);
+                        cv.notify_one();
+                    }
+                }
+                if (++finished == m_tasks.size())
+                    cv.notify_all();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned int i = 1; i < threads; ++i) {
+            pool.emplace_back(worker);
+        }
+        worker();
+
+        for (std::thread &thread : pool) {
+            thread.join();
+        }
+        m_tasks.clear();
+    }
+
+    /*  Calls work(begin, end) over consecutive chunks covering [0, count),
+     *  of at least grain iterations each, on the given number of threads.
+     *  The chunks are a few per thread, to even out their running times.
+     */
+    template <typename F>
+    void parallelFor(std::size_t count, std::size_t grain, F work, unsigned int threads) {
+        if (threads == 0) {
+            threads = defaultThreads();
+        }
+        std::size_t chunks = (count + grain - 1) / (grain == 0 ? 1 : grain);
+        if (chunks > 4 * (std::size_t) threads) {
+            chunks = 4 * (std::size_t) threads;
+        }
+        if (threads == 1 || chunks <= 1) {
+            work((std::size_t) 0, count);
+            return;
+        }
+
+        task_graph graph;
+        for (std::size_t c = 0; c < chunks; ++c) {
+            std::size_t begin = count * c / chunks;
+            std::size_t end = count * (c + 1) / chunks;
+            graph.addTask([&work, begin, end]() { work(begin, end); });
+        }
+        graph.run(threads);
+    }
+}
+
+
+#endif // PARALLEL_H
@@ -0,0 +1,174 @@
+#ifndef POWER_CACHE_H
+#define POWER_CACHE_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "matrix.h"
+#include "kernels.h"    // GEMM kernel
+#include "parallel.h"   // Threads over the rows and over the exponents
+
+
+/*                      POWER CACHE CLASS
+ *
+ *  Serves many powers of the same square matrix. Every power A^e is the
+ *  product of the squarings A^(2^i) over the set bits of e, and those are
+ *  the same for all exponents, so they are computed once, each from the
+ *  previous one, and kept: after the first request, A^e costs only its
+ *  popcount(e) - 1 multiplications, instead of the log2(e) squarings of
+ *  a fresh sqr_matrix::pow.
+ *
+ *  The cache holds at most "capacity" squarings; higher ones are only
+ *  computed for the duration of a request, so the memory stays bounded
+ *  by capacity + 1 matrices between requests. A batch of exponents
+ *  computes the squarings it needs once, with the rows of each squaring
+ *  split among the threads, and then the products of the exponents
+ *  concurrently, one exponent per thread (or, for fewer exponents than
+ *  threads, one after the other with their rows split as well).
+ *
+ *  Not thread-safe, since requests extend the cache.
+ */
+
+namespace algebra {
+    const std::size_t POWER_CACHE_CAPACITY = 32;   // Default number of squarings kept, A^(2^0) ... A^(2^31)
+    const std::size_t POWER_CACHE_GRAIN = 64;      // Rows per task of a parallel multiplication
+
+    template <class T>
+    class power_cache
+    {
+    protected:    // Class members
+        std::vector<std::vector<T>> m_squarings;   // A^(2^i), row-major
+        dimension_t m_dimension;
+        std::size_t m_capacity;
+        unsigned int m_threads;
+
+    protected:
+        void multiply(const T *, const T *, T *, unsigned int) const;
+        void product(unsigned long long, const std::vector<const T *> &, T *, unsigned int) const;
+
+    public: // Constructors
+        power_cache() = delete;
+        explicit power_cache(const sqr_matrix<T> &, std::size_t capacity = POWER_CACHE_CAPACITY,
+                             unsigned int threads = 0);
+
+    public: // Methods
+        dimension_t dimension() const { return m_dimension; }
+        std::size_t size() const { return m_squarings.size(); }
+        std::size_t capacity() const { return m_capacity; }
+
+        sqr_matrix<T> pow(unsigned long long);
+        std::vector<sqr_matrix<T>> pow(const std::vector<unsigned long long> &);
+    };
+
+
+    // --- BLUEPRINTS ---
+
+    // Explicit Constructor, copies the matrix as the squaring A^(2^0), capacity is at least 1
+    template <typename T>
+    power_cache<T>::power_cache(const sqr_matrix<T> &arg, std::size_t capacity, unsigned int threads)
+            : m_squarings(1, std::vector<T>(arg[0], arg[0] + arg.dimension() * arg.dimension())),
+              m_dimension(arg.dimension()), m_capacity(capacity == 0 ? 1 : capacity),
+              m_threads(threads == 0 ? defaultThreads() : threads) {}
+
+
+    // --- METHODS ---
+
+    // C = A * B, with the rows of C split among the threads
+    template <typename T>
+    void power_cache<T>::multiply(const T *A, const T *B, T *C, unsigned int threads) const {
+        dimension_t N = m_dimension;
+
+        std::fill(C, C + N * N, (T) 0);
+        parallelFor((std::size_t) N, POWER_CACHE_GRAIN, [=](std::size_t first, std::size_t last) {
+            multiplyAdd((dimension_t) (last - first), N, N, (T) 1, A + first * N, N, B, N, C + first * N, N);
+        }, threads);
+    }
+
+    // out = A^exp, exp > 0, as the product of the squarings of its set bits
+    template <typename T>
+    void power_cache<T>::product(unsigned long long exp, const std::vector<const T *> &squarings, T *out,
+                                 unsigned int threads) const {
+        dimension_t N = m_dimension;
+        std::vector<T> current;
+        std::vector<T> scratch((std::size_t) (N * N));
+
+        for (std::size_t bit = 0; exp != 0; ++bit, exp >>= 1) {
+            if (!(exp & 1))
+                continue;
+            if (current.empty()) {
+                current.assign(squarings[bit], squarings[bit] + N * N);
+            } else {
+                multiply(current.data(), squarings[bit], scratch.data(), threads);
+                current.swap(scratch);
+            }
+        }
+        std::copy(current.begin(), current.end(), out);
+    }
+
+    // Returns A^exp, the power 0 being the identity
+    template <typename T>
+    sqr_matrix<T> power_cache<T>::pow(unsigned long long exp) {
+        return pow(std::vector<unsigned long long>(1, exp)).front();
+    }
+
+    // Returns the powers of the matrix to each of the exponents, in their order
+    template <typename T>
+    std::vector<sqr_matrix<T>> power_cache<T>::pow(const std::vector<unsigned long long> &exponents) {
+        dimension_t N = m_dimension;
+        unsigned long long all = 0;
+
+        for (unsigned long long exp : exponents) {
+            all |= exp;
+        }
+        std::size_t bits = 0;
+        while (bits < 64 && (all >> bits) != 0)
+            ++bits;
+
+        // The squarings needed, the ones past the capacity only until the end of the request
+        std::vector<std::vector<T>> extra;
+        std::vector<const T *> squarings;
+
+        while (m_squarings.size() < bits && m_squarings.size() < m_capacity) {
+            std::vector<T> square((std::size_t) (N * N));
+            multiply(m_squarings.back().data(), m_squarings.back().data(), square.data(), m_threads);
+            m_squarings.push_back(std::move(square));
+        }
+        for (const std::vector<T> &square : m_squarings) {
+            squarings.push_back(square.data());
+        }
+        if (bits > squarings.size())
+            extra.reserve(bits - squarings.size());
+        while (squarings.size() < bits) {
+            extra.emplace_back((std::size_t) (N * N));
+            multiply(squarings.back(), squarings.back(), extra.back().data(), m_threads);
+            squarings.push_back(extra.back().data());
+        }
+
+        std::vector<sqr_matrix<T>> powers;
+        powers.reserve(exponents.size());
+        for (unsigned long long exp : exponents) {
+            powers.emplace_back(N, exp == 0);
+        }
+
+        auto compute = [&](std::size_t k, unsigned int threads) {
+            if (exponents[k] != 0)
+                product(exponents[k], squarings, powers[k][0], threads);
+        };
+        if (exponents.size() >= m_threads) {
+            parallelFor(exponents.size(), 1, [&](std::size_t first, std::size_t last) {
+                for (std::size_t k = first; k < last; ++k) {
+                    compute(k, 1);
+                }
+            }, m_threads);
+        } else {
+            for (std::size_t k = 0; k < exponents.size(); ++k) {
+                compute(k, m_threads);
+            }
+        }
+        return powers;
+    }
+}
+
+
+#endif // POWER_CACHE_H
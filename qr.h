@@ -0,0 +1,301 @@
+#ifndef QR_H
+#define QR_H
+
+#include <cmath>
+#include <vector>
+
+#include "kernels.h"    // GEMM kernels for the block reflectors
+#include "parallel.h"   // Block reflectors applied in parallel
+
+
+/*                  QR FACTORIZATION KERNELS
+ *
+ *  A = QR factorization of an M x N matrix by Householder reflections,
+ *  working in place on a row-major buffer with leading dimension lda.
+ *  With K = min(M, N), on exit the upper part of the first K rows holds R
+ *  and the vectors v of the K reflectors H = I - tau v v^T are stored
+ *  below the diagonal, their unit first scalar implied.
+ *
+ *  The reflectors are kept in compact WY form: every panel of
+ *  QR_BLOCK_SIZE of them is the block reflector I - V T V^T, with T upper
+ *  triangular, stored in the K x QR_BLOCK_SIZE buffer t (the block of the
+ *  panel starting at column j0 sits at row j0 of it). Applying a block
+ *  reflector then costs two multiplications, V^T C and V (T^T V^T C),
+ *  which run through the GEMM kernels and are split among the threads by
+ *  rows, so tall matrices keep every core busy.
+ *
+ *  The panels themselves are factorized recursively, halving their
+ *  columns down to QR_RECURSION_CUTOFF and merging the T factors of the
+ *  two halves, so that the panels also run at multiplication speed.
+ */
+
+namespace algebra {
+    typedef long long dimension_t;  // same data type as in matrix.h
+
+    const dimension_t QR_BLOCK_SIZE = 32;         // Reflectors per block of the trailing updates
+    const dimension_t QR_RECURSION_CUTOFF = 16;   // Narrowest panel split by the recursion
+
+    template <typename T> void factorHouseholder(T *, dimension_t, dimension_t, dimension_t, T *, dimension_t);
+    template <typename T> void factorPanelQR(T *, dimension_t, dimension_t, dimension_t, T *, dimension_t);
+    template <typename T> void applyBlockReflector(const T *, dimension_t, dimension_t, dimension_t, const T *, dimension_t,
+                                                   T *, dimension_t, dimension_t, bool, unsigned int threads = 1);
+    template <typename T> void factorQR(T *, dimension_t, dimension_t, dimension_t, T *, unsigned int threads = 0);
+    template <typename T> void applyQ(const T *, dimension_t, dimension_t, dimension_t, const T *,
+                                      T *, dimension_t, dimension_t, bool, unsigned int threads = 0);
+
+
+    // --- BLUEPRINTS ---
+
+    // Copies the top k x k block of V, with its implied unit diagonal and zeros above it, to v_top
+    template <typename T>
+    void unitLowerBlock(const T *v, dimension_t k, dimension_t lda, T *v_top) {
+        for (dimension_t i = 0; i < k; ++i) {
+            for (dimension_t j = 0; j < k; ++j) {
+                v_top[i * k + j] = i == j ? (T) 1 : (i > j ? v[i * lda + j] : (T) 0);
+            }
+        }
+    }
+
+    /*  Factorizes the m x k panel a (m >= k) in place, unblocked, and
+     *  computes the T factor of its reflectors (k x k, leading dimension
+     *  ldt, only its upper part is written).
+     *
+     *  The rows of a tall panel are far apart in memory, so every column
+     *  makes a single pass over them: with x the scalars of column j below
+     *  the diagonal, the reflector is v = [1, x / (alpha - beta)], hence
+     *  v^T A only needs ||x|| and x^T A, which are accumulated by the pass
+     *  of the previous column, right after it updated each row.
+     */
+    template <typename T>
+    void factorHouseholder(T *a, dimension_t m, dimension_t k, dimension_t lda, T *t, dimension_t ldt) {
+        std::vector<T> dots((std::size_t) k);     // x^T A of the current column, its own norm at index j
+        std::vector<T> w((std::size_t) k);
+
+        for (dimension_t c = 0; c < k; ++c) {
+            dots[c] = (T) 0;
+        }
+        for (dimension_t i = 1; i < m; ++i) {
+            updateRow(k, a[i * lda], a + i * lda, dots.data());
+        }
+
+        for (dimension_t j = 0; j < k; ++j) {
+            T *row_j = a + j * lda;
+            T alpha = row_j[j];
+            T norm = dots[j];
+            T tau = (T) 0;
+            T scale = (T) 1;
+
+            if (norm != (T) 0) {
+                T beta = std::sqrt(alpha * alpha + norm);
+                if (alpha > (T) 0)
+                    beta = (T) 0 - beta;
+
+                tau = (beta - alpha) / beta;
+                scale = (T) 1 / (alpha - beta);
+                row_j[j] = beta;
+            }
+            t[j * ldt + j] = tau;
+
+            // w = v^T A for the columns right of j, then row j of A -= tau w
+            for (dimension_t c = j + 1; c < k; ++c) {
+                w[c] = row_j[c] + scale * dots[c];
+                row_j[c] -= tau * w[c];
+                dots[c] = (T) 0;
+            }
+
+            // The rows below: v_i = scale * x_i, A -= tau v w^T, then x^T A of column j + 1
+            dimension_t next = j + 1;
+            for (dimension_t i = j + 1; i < m; ++i) {
+                T *row = a + i * lda;
+                row[j] *= scale;
+                if (next == k)
+                    continue;
+
+                updateRow(k - next, (T) 0 - tau * row[j], w.data() + next, row + next);
+                if (i > next)
+                    updateRow(k - next, row[next], row + next, dots.data() + next);
+            }
+        }
+
+        // T[0:j, j] = -tau_j T[0:j, 0:j] V[:, 0:j]^T v_j, from the Gram matrix of V
+        std::vector<T> gram((std::size_t) (k * k), (T) 0);
+        std::vector<T> v_top((std::size_t) (k * k));
+
+        unitLowerBlock(a, k, lda, v_top.data());
+        multiplyAddTransposed(k, k, k, (T) 1, v_top.data(), k, v_top.data(), k, gram.data(), k);
+        if (m > k) {
+            multiplyAddTransposed(k, k, m - k, (T) 1, a + k * lda, lda, a + k * lda, lda, gram.data(), k);
+        }
+
+        for (dimension_t j = 1; j < k; ++j) {
+            T tau = t[j * ldt + j];
+            for (dimension_t i = 0; i < j; ++i) {
+                T sum = (T) 0;
+                for (dimension_t l = i; l < j; ++l) {
+                    sum += t[i * ldt + l] * gram[l * k + j];
+                }
+                t[i * ldt + j] = (T) 0 - tau * sum;
+            }
+        }
+    }
+
+    /*  Factorizes the m x k panel a (m >= k) in place, recursively, and
+     *  computes the T factor of its reflectors. With the panel split into
+     *  V = [V1 V2], T = [T1  -T1 V1^T V2 T2]
+     *                   [0    T2           ]
+     */
+    template <typename T>
+    void factorPanelQR(T *a, dimension_t m, dimension_t k, dimension_t lda, T *t, dimension_t ldt) {
+        if (k <= QR_RECURSION_CUTOFF) {
+            factorHouseholder(a, m, k, lda, t, ldt);
+            return;
+        }
+        dimension_t k1 = k / 2;
+        dimension_t k2 = k - k1;
+
+        factorPanelQR(a, m, k1, lda, t, ldt);
+        applyBlockReflector(a, m, k1, lda, t, ldt, a + k1, k2, lda, true);
+        factorPanelQR(a + k1 * lda + k1, m - k1, k2, lda, t + k1 * ldt + k1, ldt);
+
+        // P = V1^T V2, V2 is zero above row k1 and unit lower triangular in rows [k1, k)
+        std::vector<T> product((std::size_t) (k1 * k2), (T) 0);
+        std::vector<T> v_top((std::size_t) (k2 * k2));
+
+        unitLowerBlock(a + k1 * lda + k1, k2, lda, v_top.data());
+        multiplyAddTransposed(k1, k2, k2, (T) 1, a + k1 * lda, lda, v_top.data(), k2, product.data(), k2);
+        if (m > k) {
+            multiplyAddTransposed(k1, k2, m - k, (T) 1, a + k * lda, lda, a + k * lda + k1, lda, product.data(), k2);
+        }
+
+        // T12 = -T1 P T2, both triangular factors read as full blocks with zeros below their diagonal
+        std::vector<T> t1((std::size_t) (k1 * k1), (T) 0);
+        std::vector<T> t2((std::size_t) (k2 * k2), (T) 0);
+        std::vector<T> partial((std::size_t) (k1 * k2), (T) 0);
+
+        for (dimension_t i = 0; i < k1; ++i) {
+            for (dimension_t j = i; j < k1; ++j) {
+                t1[i * k1 + j] = t[i * ldt + j];
+            }
+        }
+        for (dimension_t i = 0; i < k2; ++i) {
+            for (dimension_t j = i; j < k2; ++j) {
+                t2[i * k2 + j] = t[(k1 + i) * ldt + k1 + j];
+            }
+        }
+        multiplyAdd(k1, k2, k1, (T) 1, t1.data(), k1, product.data(), k2, partial.data(), k2);
+        for (dimension_t i = 0; i < k1; ++i) {
+            for (dimension_t j = 0; j < k2; ++j) {
+                t[i * ldt + k1 + j] = (T) 0;
+            }
+        }
+        multiplyAdd(k1, k2, k2, (T) -1, partial.data(), k2, t2.data(), k2, t + k1, ldt);
+    }
+
+    /*  Applies the block reflector H = I - V T V^T of the k reflectors stored
+     *  in the m x k block v (leading dimension lda), with the T factor t, to
+     *  the m x n block c: C = H^T C if transpose, C = H C otherwise.
+     *  The rows below the top k x k block of V are split among the threads,
+     *  the result only depending on their number, not on their timing.
+     */
+    template <typename T>
+    void applyBlockReflector(const T *v, dimension_t m, dimension_t k, dimension_t lda, const T *t, dimension_t ldt,
+                             T *c, dimension_t n, dimension_t ldc, bool transpose, unsigned int threads) {
+        std::vector<T> v_top((std::size_t) (k * k));
+        std::vector<T> t_full((std::size_t) (k * k), (T) 0);
+        std::vector<T> w((std::size_t) (k * n), (T) 0);
+        std::vector<T> tw((std::size_t) (k * n), (T) 0);
+
+        unitLowerBlock(v, k, lda, v_top.data());
+        for (dimension_t i = 0; i < k; ++i) {
+            for (dimension_t j = i; j < k; ++j) {
+                t_full[i * k + j] = t[i * ldt + j];
+            }
+        }
+
+        /*  W = V^T C, the partial sums of the row chunks written to their own
+         *  slots and added up in chunk order, so that the result does not
+         *  depend on which thread finishes first
+         */
+        std::size_t rows = (std::size_t) (m - k);
+        std::size_t size = (std::size_t) (k * n);
+        std::size_t chunks = (rows + KERNEL_BLOCK_N - 1) / KERNEL_BLOCK_N;
+        unsigned int workers = threads == 0 ? defaultThreads() : threads;
+
+        if (chunks > 4 * (std::size_t) workers) {
+            chunks = 4 * (std::size_t) workers;
+        }
+        std::vector<T> partial(chunks * size, (T) 0);
+
+        multiplyAddTransposed(k, n, k, (T) 1, v_top.data(), k, c, ldc, w.data(), n);
+        parallelFor(chunks, 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t chunk = first; chunk < last; ++chunk) {
+                dimension_t i0 = k + (dimension_t) (rows * chunk / chunks);
+                dimension_t i1 = k + (dimension_t) (rows * (chunk + 1) / chunks);
+
+                multiplyAddTransposed(k, n, i1 - i0, (T) 1, v + i0 * lda, lda, c + i0 * ldc, ldc,
+                                      partial.data() + chunk * size, n);
+            }
+        }, workers);
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+            updateRow((dimension_t) size, (T) 1, partial.data() + chunk * size, w.data());
+        }
+
+        // TW = T^T W or T W
+        if (transpose) {
+            multiplyAddTransposed(k, n, k, (T) 1, t_full.data(), k, w.data(), n, tw.data(), n);
+        } else {
+            multiplyAdd(k, n, k, (T) 1, t_full.data(), k, w.data(), n, tw.data(), n);
+        }
+
+        // C -= V TW
+        multiplyAdd(k, n, k, (T) -1, v_top.data(), k, tw.data(), n, c, ldc);
+        parallelFor((std::size_t) (m - k), (std::size_t) (KERNEL_BLOCK_N), [&](std::size_t first, std::size_t last) {
+            dimension_t i0 = k + (dimension_t) first;
+            multiplyAdd((dimension_t) (last - first), n, k, (T) -1, v + i0 * lda, lda, tw.data(), n, c + i0 * ldc, ldc);
+        }, threads);
+    }
+
+    /*  Factorizes the M x N matrix a in place, t receives the T factors and
+     *  must hold min(M, N) x QR_BLOCK_SIZE scalars.
+     */
+    template <typename T>
+    void factorQR(T *a, dimension_t M, dimension_t N, dimension_t lda, T *t, unsigned int threads) {
+        dimension_t K = M < N ? M : N;
+
+        for (dimension_t i = 0; i < K * QR_BLOCK_SIZE; ++i) {
+            t[i] = (T) 0;
+        }
+        for (dimension_t j0 = 0; j0 < K; j0 += QR_BLOCK_SIZE) {
+            dimension_t kb = j0 + QR_BLOCK_SIZE < K ? QR_BLOCK_SIZE : K - j0;
+            T *panel = a + j0 * lda + j0;
+            T *t_panel = t + j0 * QR_BLOCK_SIZE;
+
+            factorPanelQR(panel, M - j0, kb, lda, t_panel, QR_BLOCK_SIZE);
+            if (j0 + kb < N) {
+                applyBlockReflector(panel, M - j0, kb, lda, t_panel, QR_BLOCK_SIZE, panel + kb, N - j0 - kb, lda, true, threads);
+            }
+        }
+    }
+
+    /*  Applies Q^T (transpose) or Q, as factorized by factorQR from an M x N
+     *  matrix, to the M x n block c.
+     */
+    template <typename T>
+    void applyQ(const T *a, dimension_t M, dimension_t N, dimension_t lda, const T *t,
+                T *c, dimension_t n, dimension_t ldc, bool transpose, unsigned int threads) {
+        dimension_t K = M < N ? M : N;
+        dimension_t blocks = (K + QR_BLOCK_SIZE - 1) / QR_BLOCK_SIZE;
+
+        // Q = H_0 H_1 ..., so Q^T applies the blocks in order and Q in reverse
+        for (dimension_t b = 0; b < blocks; ++b) {
+            dimension_t j0 = (transpose ? b : blocks - 1 - b) * QR_BLOCK_SIZE;
+            dimension_t kb = j0 + QR_BLOCK_SIZE < K ? QR_BLOCK_SIZE : K - j0;
+
+            applyBlockReflector(a + j0 * lda + j0, M - j0, kb, lda, t + j0 * QR_BLOCK_SIZE, QR_BLOCK_SIZE,
+                                c + j0 * ldc, n, ldc, transpose, threads);
+        }
+    }
+}
+
+
+#endif // QR_H
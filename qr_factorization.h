@@ -0,0 +1,188 @@
+#ifndef QR_FACTORIZATION_H
+#define QR_FACTORIZATION_H
+
+#include <iostream>
+
+#include "matrix.h"
+#include "qr.h"         // Householder QR kernels
+
+
+/*                   QR FACTORIZATION CLASS
+ *
+ *  Keeps the A = QR factorization of an M x N matrix, square or not,
+ *  with Q held implicitly by its Householder reflectors (head to qr.h).
+ *  For M >= N and A of full rank, solve() returns the least-squares
+ *  solution of A X = B: X = R^-1 (Q^T B)[0:N], which is how fits on tall
+ *  matrices should be computed, rather than through the normal equations
+ *  A^T A X = A^T B, which square the condition number.
+ *
+ *  Lazy and not thread-safe until factorized, as lu_factorization.
+ */
+
+namespace algebra {
+    template <class T>
+    class qr_factorization
+    {
+    protected:    // Class members
+        mutable matrix<double> m_qr;        // The matrix, then R and the reflectors
+        mutable matrix<double> m_t;         // T factors of the blocks of reflectors
+        mutable bool m_factorized;
+        unsigned int m_threads;
+
+    public: // Constructors
+        qr_factorization() = delete;
+        explicit qr_factorization(const matrix<T> &, unsigned int threads = 0);
+
+    public: // Methods
+        void factorize() const;
+        bool isFactorized() const { return m_factorized; }
+        dimension_t numOfRows() const { return m_qr.numOfRows(); }
+        dimension_t numOfCols() const { return m_qr.numOfCols(); }
+        dimension_t numOfReflectors() const { return m_t.numOfRows(); }
+
+        matrix<double> R() const;
+        matrix<double> Q() const;
+        matrix<double> applyQ(const matrix<double> &) const;
+        matrix<double> applyQTransposed(const matrix<double> &) const;
+        matrix<double> solve(const matrix<double> &) const;
+    };
+
+    template <typename T> matrix<double> leastSquares(const matrix<T> &, const matrix<T> &);
+
+
+    // --- BLUEPRINTS ---
+
+    // Explicit Constructor, copies the matrix without factorizing it
+    template <typename T>
+    qr_factorization<T>::qr_factorization(const matrix<T> &arg, unsigned int threads)
+            : m_qr(arg.numOfRows(), arg.numOfCols()),
+              m_t(arg.numOfRows() < arg.numOfCols() ? arg.numOfRows() : arg.numOfCols(), QR_BLOCK_SIZE),
+              m_factorized(false), m_threads(threads) {
+        for (dimension_t i = 0; i < arg.numOfRows(); ++i) {
+            for (dimension_t j = 0; j < arg.numOfCols(); ++j) {
+                m_qr[i][j] = (double) arg[i][j];
+            }
+        }
+    }
+
+
+    // --- METHODS ---
+
+    // Factorizes the matrix, if not already done
+    template <typename T>
+    void qr_factorization<T>::factorize() const {
+        if (!m_factorized) {
+            factorQR(m_qr[0], numOfRows(), numOfCols(), numOfCols(), m_t[0], m_threads);
+            m_factorized = true;
+        }
+    }
+
+    // Returns the min(M, N) x N upper trapezoidal factor R
+    template <typename T>
+    matrix<double> qr_factorization<T>::R() const {
+        factorize();
+        matrix<double> R(numOfReflectors(), numOfCols());
+
+        for (dimension_t i = 0; i < R.numOfRows(); ++i) {
+            for (dimension_t j = 0; j < R.numOfCols(); ++j) {
+                R[i][j] = j < i ? 0.0 : m_qr[i][j];
+            }
+        }
+        return R;
+    }
+
+    // Returns the M x min(M, N) factor Q with orthonormal columns, the "thin" Q
+    template <typename T>
+    matrix<double> qr_factorization<T>::Q() const {
+        matrix<double> identity(numOfRows(), numOfReflectors());
+
+        identity.init(0.0);
+        for (dimension_t i = 0; i < numOfReflectors(); ++i) {
+            identity[i][i] = 1.0;
+        }
+        return applyQ(identity);
+    }
+
+    // Returns Q B, for B with M rows
+    template <typename T>
+    matrix<double> qr_factorization<T>::applyQ(const matrix<double> &B) const {
+        if (B.numOfRows() != numOfRows()) {
+            std::cerr << "Error: cannot multiply by Q, rows do not match" << std::endl;
+            return matrix<double>(1, 1);
+        }
+        factorize();
+        matrix<double> C(B);
+
+        algebra::applyQ(m_qr[0], numOfRows(), numOfCols(), numOfCols(), m_t[0], C[0], C.numOfCols(), C.numOfCols(),
+                        false, m_threads);
+        return C;
+    }
+
+    // Returns Q^T B, for B with M rows
+    template <typename T>
+    matrix<double> qr_factorization<T>::applyQTransposed(const matrix<double> &B) const {
+        if (B.numOfRows() != numOfRows()) {
+            std::cerr << "Error: cannot multiply by Q^T, rows do not match" << std::endl;
+            return matrix<double>(1, 1);
+        }
+        factorize();
+        matrix<double> C(B);
+
+        algebra::applyQ(m_qr[0], numOfRows(), numOfCols(), numOfCols(), m_t[0], C[0], C.numOfCols(), C.numOfCols(),
+                        true, m_threads);
+        return C;
+    }
+
+    /*  Returns the N x columns least-squares solution X of A X = B,
+     *  minimizing ||A X - B|| column by column. Requires M >= N and A of
+     *  full column rank.
+     */
+    template <typename T>
+    matrix<double> qr_factorization<T>::solve(const matrix<double> &B) const {
+        dimension_t N = numOfCols();
+
+        if (numOfRows() < N) {
+            std::cerr << "Error: cannot solve the least-squares problem\n"
+                      << "The matrix has fewer rows than columns"
+                      << std::endl;
+            return matrix<double>(1, 1);
+        }
+        matrix<double> C = applyQTransposed(B);
+        if (C.numOfRows() != numOfRows()) {
+            return C;
+        }
+        for (dimension_t i = 0; i < N; ++i) {
+            if (m_qr[i][i] == 0) {
+                std::cerr << "Error: cannot solve the least-squares problem, the matrix is rank deficient" << std::endl;
+                return matrix<double>(1, 1);
+            }
+        }
+
+        // X = R^-1 C[0:N]
+        matrix<double> X(N, C.numOfCols());
+        for (dimension_t i = 0; i < N; ++i) {
+            for (dimension_t j = 0; j < C.numOfCols(); ++j) {
+                X[i][j] = C[i][j];
+            }
+        }
+        solveUpper(N, X.numOfCols(), m_qr[0], N, X[0], X.numOfCols());
+        return X;
+    }
+
+    // Returns the least-squares solution of A X = B, by a one-off factorization of A
+    template <typename T>
+    matrix<double> leastSquares(const matrix<T> &A, const matrix<T> &B) {
+        qr_factorization<T> qr(A);
+        matrix<double> rhs(B.numOfRows(), B.numOfCols());
+
+        for (dimension_t i = 0; i < B.numOfRows(); ++i) {
+            for (dimension_t j = 0; j < B.numOfCols(); ++j) {
+                rhs[i][j] = (double) B[i][j];
+            }
+        }
+        return qr.solve(rhs);
+    }
+}
+
+
+#endif // QR_FACTORIZATION_H
@@ -0,0 +1,192 @@
+#ifndef STRASSEN_H
+#define STRASSEN_H
+
+#include <vector>
+
+#include "kernels.h"    // Cubic kernels below the cutoff
+
+
+/*                  FAST MATRIX MULTIPLICATION
+ *
+ *  Strassen's algorithm: the product of 2 x 2 block matrices with seven
+ *  block multiplications instead of eight, applied recursively, costs
+ *  O(n^log2(7)) = O(n^2.807) instead of O(n^3). It is the only member of
+ *  the fast multiplication family (Coppersmith-Winograd and its
+ *  successors included) whose constant is small enough to win at
+ *  practical sizes, so it is what the sub-cubic algorithms of this
+ *  library are built on.
+ *
+ *  The recursion stops at STRASSEN_CUTOFF, below which the cache-blocked
+ *  multiplyAdd is faster. Odd dimensions are handled by peeling: the
+ *  even part recurses, and the last row, column or inner index is added
+ *  by multiplyAdd, so any rectangular shape is accepted.
+ *
+ *  The triangular solves are recursive as well, halving the triangular
+ *  matrix and updating the second half by one fast multiplication, so
+ *  their exponent is the one of the multiplication. Algorithms built on
+ *  them (see lu_engine::fast in lu.h) inherit it too.
+ *
+ *  Strassen's algorithm is normwise but not componentwise stable: its
+ *  error bound grows with a small power of n and with ||A|| ||B||
+ *  instead of |A| |B|, which is harmless for most, but not all inputs.
+ */
+
+namespace algebra {
+    typedef long long dimension_t;  // same data type as in matrix.h
+
+    const dimension_t STRASSEN_CUTOFF = 256;   // Smallest dimension split by the recursion
+
+    template <typename T> void multiplyStrassen(dimension_t, dimension_t, dimension_t, T, const T *, dimension_t, const T *, dimension_t, T *, dimension_t);
+    template <typename T> void solveUnitLowerFast(dimension_t, dimension_t, const T *, dimension_t, T *, dimension_t);
+    template <typename T> void solveUpperFast(dimension_t, dimension_t, const T *, dimension_t, T *, dimension_t);
+
+
+    // --- BLUEPRINTS ---
+
+    // D = one + sign * two, where every block is rows x columns, D contiguous
+    template <typename T>
+    void combineBlocks(dimension_t rows, dimension_t columns, const T *one, dimension_t ld_one,
+                       const T *two, dimension_t ld_two, T sign, T *D) {
+        for (dimension_t i = 0; i < rows; ++i) {
+            for (dimension_t j = 0; j < columns; ++j) {
+                D[i * columns + j] = one[i * ld_one + j] + sign * two[i * ld_two + j];
+            }
+        }
+    }
+
+    // C += alpha * P, where P is rows x columns and contiguous
+    template <typename T>
+    void addBlock(dimension_t rows, dimension_t columns, T alpha, const T *P, T *C, dimension_t ldc) {
+        for (dimension_t i = 0; i < rows; ++i) {
+            updateRow(columns, alpha, P + i * columns, C + i * ldc);
+        }
+    }
+
+    /*  C += alpha * A * B, where A is M x K, B is K x N and C is M x N, the
+     *  same contract as multiplyAdd. With the blocks of the even part,
+     *      P1 = (A11 + A22)(B11 + B22)     C11 += P1 + P4 - P5 + P7
+     *      P2 = (A21 + A22) B11            C12 += P3 + P5
+     *      P3 = A11 (B12 - B22)            C21 += P2 + P4
+     *      P4 = A22 (B21 - B11)            C22 += P1 - P2 + P3 + P6
+     *      P5 = (A11 + A12) B22
+     *      P6 = (A21 - A11)(B11 + B12)
+     *      P7 = (A12 - A22)(B21 + B22)
+     */
+    template <typename T>
+    void multiplyStrassen(dimension_t M, dimension_t N, dimension_t K, T alpha,
+                          const T *A, dimension_t lda, const T *B, dimension_t ldb, T *C, dimension_t ldc) {
+        if (M <= STRASSEN_CUTOFF || N <= STRASSEN_CUTOFF || K <= STRASSEN_CUTOFF) {
+            multiplyAdd(M, N, K, alpha, A, lda, B, ldb, C, ldc);
+            return;
+        }
+        dimension_t m = M / 2, n = N / 2, k = K / 2;
+
+        const T *A11 = A, *A12 = A + k, *A21 = A + m * lda, *A22 = A21 + k;
+        const T *B11 = B, *B12 = B + n, *B21 = B + k * ldb, *B22 = B21 + n;
+        T *C11 = C, *C12 = C + n, *C21 = C + m * ldc, *C22 = C21 + n;
+
+        std::vector<T> left((std::size_t) (m * k));
+        std::vector<T> right((std::size_t) (k * n));
+        std::vector<T> product((std::size_t) (m * n));
+
+        // product = one * two, of m x k and k x n blocks
+        auto multiply = [&](const T *one, dimension_t ld_one, const T *two, dimension_t ld_two) {
+            for (T &scalar : product)
+                scalar = (T) 0;
+            multiplyStrassen(m, n, k, (T) 1, one, ld_one, two, ld_two, product.data(), n);
+        };
+
+        // P1
+        combineBlocks(m, k, A11, lda, A22, lda, (T) 1, left.data());
+        combineBlocks(k, n, B11, ldb, B22, ldb, (T) 1, right.data());
+        multiply(left.data(), k, right.data(), n);
+        addBlock(m, n, alpha, product.data(), C11, ldc);
+        addBlock(m, n, alpha, product.data(), C22, ldc);
+
+        // P2, B11 is used as it is
+        combineBlocks(m, k, A21, lda, A22, lda, (T) 1, left.data());
+        multiply(left.data(), k, B11, ldb);
+        addBlock(m, n, alpha, product.data(), C21, ldc);
+        addBlock(m, n, (T) 0 - alpha, product.data(), C22, ldc);
+
+        // P3, A11 is used as it is
+        combineBlocks(k, n, B12, ldb, B22, ldb, (T) -1, right.data());
+        multiply(A11, lda, right.data(), n);
+        addBlock(m, n, alpha, product.data(), C12, ldc);
+        addBlock(m, n, alpha, product.data(), C22, ldc);
+
+        // P4, A22 is used as it is
+        combineBlocks(k, n, B21, ldb, B11, ldb, (T) -1, right.data());
+        multiply(A22, lda, right.data(), n);
+        addBlock(m, n, alpha, product.data(), C11, ldc);
+        addBlock(m, n, alpha, product.data(), C21, ldc);
+
+        // P5, B22 is used as it is
+        combineBlocks(m, k, A11, lda, A12, lda, (T) 1, left.data());
+        multiply(left.data(), k, B22, ldb);
+        addBlock(m, n, (T) 0 - alpha, product.data(), C11, ldc);
+        addBlock(m, n, alpha, product.data(), C12, ldc);
+
+        // P6
+        combineBlocks(m, k, A21, lda, A11, lda, (T) -1, left.data());
+        combineBlocks(k, n, B11, ldb, B12, ldb, (T) 1, right.data());
+        multiply(left.data(), k, right.data(), n);
+        addBlock(m, n, alpha, product.data(), C22, ldc);
+
+        // P7
+        combineBlocks(m, k, A12, lda, A22, lda, (T) -1, left.data());
+        combineBlocks(k, n, B21, ldb, B22, ldb, (T) 1, right.data());
+        multiply(left.data(), k, right.data(), n);
+        addBlock(m, n, alpha, product.data(), C11, ldc);
+
+        // Peeling of the odd dimensions
+        dimension_t M_even = 2 * m, N_even = 2 * n, K_even = 2 * k;
+
+        if (K_even < K) {
+            multiplyAdd(M_even, N_even, 1, alpha, A + K_even, lda, B + K_even * ldb, ldb, C, ldc);
+        }
+        if (N_even < N) {
+            multiplyAdd(M_even, 1, K, alpha, A, lda, B + N_even, ldb, C + N_even, ldc);
+        }
+        if (M_even < M) {
+            multiplyAdd(1, N, K, alpha, A + M_even * lda, lda, B, ldb, C + M_even * ldc, ldc);
+        }
+    }
+
+    /*  TRSM: B = L^-1 * B, where L is an M x M unit lower triangular matrix
+     *  (only its strictly lower part is read) and B is M x N, recursively:
+     *  B1 = L11^-1 B1, B2 -= L21 B1 by fast multiplication, B2 = L22^-1 B2.
+     */
+    template <typename T>
+    void solveUnitLowerFast(dimension_t M, dimension_t N, const T *L, dimension_t ldl, T *B, dimension_t ldb) {
+        if (M <= STRASSEN_CUTOFF) {
+            solveUnitLower(M, N, L, ldl, B, ldb);
+            return;
+        }
+        dimension_t m1 = M / 2;
+
+        solveUnitLowerFast(m1, N, L, ldl, B, ldb);
+        multiplyStrassen(M - m1, N, m1, (T) -1, L + m1 * ldl, ldl, B, ldb, B + m1 * ldb, ldb);
+        solveUnitLowerFast(M - m1, N, L + m1 * ldl + m1, ldl, B + m1 * ldb, ldb);
+    }
+
+    /*  TRSM: B = U^-1 * B, where U is an M x M upper triangular matrix
+     *  (only its upper part is read) with a non-zero diagonal and B is M x N,
+     *  recursively from the bottom half upwards.
+     */
+    template <typename T>
+    void solveUpperFast(dimension_t M, dimension_t N, const T *U, dimension_t ldu, T *B, dimension_t ldb) {
+        if (M <= STRASSEN_CUTOFF) {
+            solveUpper(M, N, U, ldu, B, ldb);
+            return;
+        }
+        dimension_t m1 = M / 2;
+
+        solveUpperFast(M - m1, N, U + m1 * ldu + m1, ldu, B + m1 * ldb, ldb);
+        multiplyStrassen(m1, N, M - m1, (T) -1, U + m1, ldu, B + m1 * ldb, ldb, B, ldb);
+        solveUpperFast(m1, N, U, ldu, B, ldb);
+    }
+}
+
+
+#endif // STRASSEN_H
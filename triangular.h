@@ -0,0 +1,434 @@
+#ifndef TRIANGULAR_H
+#define TRIANGULAR_H
+
+#include <iostream>
+#include <iomanip>
+#include <type_traits>
+
+
+/*                    TRIANGULAR MATRIX CLASSES
+ *
+ *  Lower and upper triangular  square matrices,  such as the two
+ *  factors of the LU decomposition. Only the non-zero half of the
+ *  matrix is stored, so they need half the memory of a sqr_matrix
+ *  and their multiplication kernels skip the zero blocks entirely,
+ *  which halves the number of floating point operations.
+ */
+
+namespace algebra {
+    typedef long long dimension_t;  // same data type as in matrix.h
+
+    template <class T> class matrix;
+    template <class T> class sqr_matrix;
+
+    template <class T>
+    class lower_triangular
+    {
+        /*  The scalars are packed row by row in a one-dimensional array.
+         *  Row i holds the i + 1 scalars [i][0] ... [i][i] and starts at
+         *  offset i * (i + 1) / 2, for a total of N * (N + 1) / 2 scalars.
+         */
+    protected:    // Class members
+        T *m_matrix;                // Packed non-zero half of the matrix
+        dimension_t m_dimension;    // Number of rows and columns
+
+    protected:
+        T *getRow(dimension_t i) const { return m_matrix + i * (i + 1) / 2; }
+
+    public: // Constructors -- Destructor
+        lower_triangular() = delete;
+        explicit lower_triangular(dimension_t N, bool UNARY = false);
+        lower_triangular(const lower_triangular<T> &);
+        ~lower_triangular();
+
+    public: // Class Methods
+        void init(T);
+        dimension_t dimension() const { return m_dimension; }
+        T at(dimension_t i, dimension_t j) const { return j <= i ? getRow(i)[j] : (T) 0; }
+        sqr_matrix<T> toSquare() const;
+
+    public: // Operators
+        lower_triangular<T> &operator = (const lower_triangular<T> &);
+
+        // L[i][j] is only valid for j <= i, use at() for the zero half
+        T *operator [] (dimension_t i) const { return getRow(i); }
+    };
+
+    template <class T>
+    class upper_triangular
+    {
+        /*  The scalars are packed row by row in a one-dimensional array.
+         *  Row i holds the N - i scalars [i][i] ... [i][N - 1], for a total
+         *  of N * (N + 1) / 2 scalars. getRow() returns a pointer shifted
+         *  back by i positions, so that U[i][j] addresses column j.
+         */
+    protected:    // Class members
+        T *m_matrix;                // Packed non-zero half of the matrix
+        dimension_t m_dimension;    // Number of rows and columns
+
+    protected:
+        T *getRow(dimension_t i) const { return m_matrix + i * (m_dimension - 1) - i * (i - 1) / 2; }
+
+    public: // Constructors -- Destructor
+        upper_triangular() = delete;
+        explicit upper_triangular(dimension_t N, bool UNARY = false);
+        upper_triangular(const upper_triangular<T> &);
+        ~upper_triangular();
+
+    public: // Class Methods
+        void init(T);
+        dimension_t dimension() const { return m_dimension; }
+        T at(dimension_t i, dimension_t j) const { return j >= i ? getRow(i)[j] : (T) 0; }
+        sqr_matrix<T> toSquare() const;
+
+    public: // Operators
+        upper_triangular<T> &operator = (const upper_triangular<T> &);
+
+        // U[i][j] is only valid for j >= i, use at() for the zero half
+        T *operator [] (dimension_t i) const { return getRow(i); }
+    };
+
+    // Operators
+    template <typename T> lower_triangular<T> operator * (const lower_triangular<T> &, const lower_triangular<T> &);
+    template <typename T> upper_triangular<T> operator * (const upper_triangular<T> &, const upper_triangular<T> &);
+    template <typename T> sqr_matrix<T> operator * (const lower_triangular<T> &, const upper_triangular<T> &);
+    template <typename T> sqr_matrix<T> operator * (const upper_triangular<T> &, const lower_triangular<T> &);
+    template <typename T> matrix<T> operator * (const lower_triangular<T> &, const matrix<T> &);
+    template <typename T> matrix<T> operator * (const upper_triangular<T> &, const matrix<T> &);
+    template <typename T> std::ostream &operator << (std::ostream &, const lower_triangular<T> &);
+    template <typename T> std::ostream &operator << (std::ostream &, const upper_triangular<T> &);
+
+
+    // --- BLUEPRINTS ---
+
+    // Explicit Constructors
+    template <typename T>
+    lower_triangular<T>::lower_triangular(dimension_t N, bool UNARY) {
+        static_assert(std::is_trivially_copyable<T>::value, "Matrix's scalars must be trivially copyable");
+
+        if (N < 1) {
+            std::cerr << "Matrix construction error: non-positive dimension" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        m_matrix = new T[(std::size_t) (N * (N + 1) / 2)];
+        m_dimension = N;
+
+        // If UNARY == true, the unary matrix (In) of dimension N is constructed
+        if (UNARY) {
+            init((T) 0);
+            for (dimension_t i = 0; i < N; ++i)
+                (*this)[i][i] = (T) 1;
+        }
+    }
+
+    template <typename T>
+    upper_triangular<T>::upper_triangular(dimension_t N, bool UNARY) {
+        static_assert(std::is_trivially_copyable<T>::value, "Matrix's scalars must be trivially copyable");
+
+        if (N < 1) {
+            std::cerr << "Matrix construction error: non-positive dimension" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        m_matrix = new T[(std::size_t) (N * (N + 1) / 2)];
+        m_dimension = N;
+
+        if (UNARY) {
+            init((T) 0);
+            for (dimension_t i = 0; i < N; ++i)
+                (*this)[i][i] = (T) 1;
+        }
+    }
+
+    // Copy Constructors
+    template <typename T>
+    lower_triangular<T>::lower_triangular(const lower_triangular<T> &prototype) {
+        m_dimension = prototype.m_dimension;
+        dimension_t total = m_dimension * (m_dimension + 1) / 2;
+        m_matrix = new T[(std::size_t) total];
+
+        for (dimension_t i = 0; i < total; ++i) {
+            m_matrix[i] = prototype.m_matrix[i];
+        }
+    }
+
+    template <typename T>
+    upper_triangular<T>::upper_triangular(const upper_triangular<T> &prototype) {
+        m_dimension = prototype.m_dimension;
+        dimension_t total = m_dimension * (m_dimension + 1) / 2;
+        m_matrix = new T[(std::size_t) total];
+
+        for (dimension_t i = 0; i < total; ++i) {
+            m_matrix[i] = prototype.m_matrix[i];
+        }
+    }
+
+    // Destructors
+    template <typename T>
+    lower_triangular<T>::~lower_triangular() {
+        delete[] m_matrix;
+    }
+
+    template <typename T>
+    upper_triangular<T>::~upper_triangular() {
+        delete[] m_matrix;
+    }
+
+
+    // --- METHODS ---
+
+    // Initialises the stored half of the matrix with the given argument
+    template <typename T>
+    void lower_triangular<T>::init(T init_arg) {
+        dimension_t total = m_dimension * (m_dimension + 1) / 2;
+        for (dimension_t i = 0; i < total; ++i) {
+            m_matrix[i] = init_arg;
+        }
+    }
+
+    template <typename T>
+    void upper_triangular<T>::init(T init_arg) {
+        dimension_t total = m_dimension * (m_dimension + 1) / 2;
+        for (dimension_t i = 0; i < total; ++i) {
+            m_matrix[i] = init_arg;
+        }
+    }
+
+    // Returns the dense square matrix, with the zero half explicitly stored
+    template <typename T>
+    sqr_matrix<T> lower_triangular<T>::toSquare() const {
+        sqr_matrix<T> square(m_dimension);
+
+        for (dimension_t i = 0; i < m_dimension; ++i) {
+            for (dimension_t j = 0; j < m_dimension; ++j) {
+                square[i][j] = at(i, j);
+            }
+        }
+        return square;
+    }
+
+    template <typename T>
+    sqr_matrix<T> upper_triangular<T>::toSquare() const {
+        sqr_matrix<T> square(m_dimension);
+
+        for (dimension_t i = 0; i < m_dimension; ++i) {
+            for (dimension_t j = 0; j < m_dimension; ++j) {
+                square[i][j] = at(i, j);
+            }
+        }
+        return square;
+    }
+
+
+    // --- OPERATORS ---
+
+    // Assignment operators
+    template <typename T>
+    lower_triangular<T> &lower_triangular<T>::operator = (const lower_triangular<T> &arg) {
+        if (this != &arg) {
+            m_dimension = arg.m_dimension;
+            dimension_t total = m_dimension * (m_dimension + 1) / 2;
+
+            delete[] m_matrix;
+            m_matrix = new T[(std::size_t) total];
+
+            for (dimension_t i = 0; i < total; ++i) {
+                m_matrix[i] = arg.m_matrix[i];
+            }
+        }
+        return *this;
+    }
+
+    template <typename T>
+    upper_triangular<T> &upper_triangular<T>::operator = (const upper_triangular<T> &arg) {
+        if (this != &arg) {
+            m_dimension = arg.m_dimension;
+            dimension_t total = m_dimension * (m_dimension + 1) / 2;
+
+            delete[] m_matrix;
+            m_matrix = new T[(std::size_t) total];
+
+            for (dimension_t i = 0; i < total; ++i) {
+                m_matrix[i] = arg.m_matrix[i];
+            }
+        }
+        return *this;
+    }
+
+    /*  The multiplication kernels below run in i-k-j order, so that the
+     *  innermost loop walks contiguously over a row of both the second
+     *  factor and the product, and the bounds of k and j are clipped to
+     *  the non-zero halves of the factors.
+     */
+
+    // Multiplication operator -- two lower triangular matrices
+    template <typename T>
+    lower_triangular<T> operator * (const lower_triangular<T> &one, const lower_triangular<T> &two) {
+        if (one.dimension() != two.dimension()) {
+            std::cerr << "Error: cannot multiply matrices\n"
+                      << "Columns and rows of instances do not match"
+                      << std::endl;
+            return lower_triangular<T>(1);
+        }
+        lower_triangular<T> prod(one.dimension());
+
+        prod.init((T) 0);
+
+        for (dimension_t i = 0; i < one.dimension(); i++) {
+            for (dimension_t k = 0; k <= i; k++) {
+                T scalar = one[i][k];
+                for (dimension_t j = 0; j <= k; j++) {
+                    prod[i][j] += scalar * two[k][j];
+                }
+            }
+        }
+        return prod;
+    }
+
+    // Multiplication operator -- two upper triangular matrices
+    template <typename T>
+    upper_triangular<T> operator * (const upper_triangular<T> &one, const upper_triangular<T> &two) {
+        if (one.dimension() != two.dimension()) {
+            std::cerr << "Error: cannot multiply matrices\n"
+                      << "Columns and rows of instances do not match"
+                      << std::endl;
+            return upper_triangular<T>(1);
+        }
+        upper_triangular<T> prod(one.dimension());
+
+        prod.init((T) 0);
+
+        for (dimension_t i = 0; i < one.dimension(); i++) {
+            for (dimension_t k = i; k < one.dimension(); k++) {
+                T scalar = one[i][k];
+                for (dimension_t j = k; j < two.dimension(); j++) {
+                    prod[i][j] += scalar * two[k][j];
+                }
+            }
+        }
+        return prod;
+    }
+
+    // Multiplication operator -- lower by upper triangular, reconstructs A = LU
+    template <typename T>
+    sqr_matrix<T> operator * (const lower_triangular<T> &one, const upper_triangular<T> &two) {
+        if (one.dimension() != two.dimension()) {
+            std::cerr << "Error: cannot multiply matrices\n"
+                      << "Columns and rows of instances do not match"
+                      << std::endl;
+            return sqr_matrix<T>(1);
+        }
+        sqr_matrix<T> prod(one.dimension());
+
+        prod.init((T) 0);
+
+        for (dimension_t i = 0; i < one.dimension(); i++) {
+            for (dimension_t k = 0; k <= i; k++) {
+                T scalar = one[i][k];
+                for (dimension_t j = k; j < two.dimension(); j++) {
+                    prod[i][j] += scalar * two[k][j];
+                }
+            }
+        }
+        return prod;
+    }
+
+    // Multiplication operator -- upper by lower triangular
+    template <typename T>
+    sqr_matrix<T> operator * (const upper_triangular<T> &one, const lower_triangular<T> &two) {
+        if (one.dimension() != two.dimension()) {
+            std::cerr << "Error: cannot multiply matrices\n"
+                      << "Columns and rows of instances do not match"
+                      << std::endl;
+            return sqr_matrix<T>(1);
+        }
+        sqr_matrix<T> prod(one.dimension());
+
+        prod.init((T) 0);
+
+        for (dimension_t i = 0; i < one.dimension(); i++) {
+            for (dimension_t k = i; k < one.dimension(); k++) {
+                T scalar = one[i][k];
+                for (dimension_t j = 0; j <= k; j++) {
+                    prod[i][j] += scalar * two[k][j];
+                }
+            }
+        }
+        return prod;
+    }
+
+    // Multiplication operator -- lower triangular applied to a matrix
+    template <typename T>
+    matrix<T> operator * (const lower_triangular<T> &one, const matrix<T> &two) {
+        if (one.dimension() != two.numOfRows()) {
+            std::cerr << "Error: cannot multiply matrices\n"
+                      << "Columns and rows of instances do not match"
+                      << std::endl;
+            return matrix<T>(1, 1);
+        }
+        matrix<T> prod(one.dimension(), two.numOfCols());
+
+        prod.init((T) 0);
+
+        for (dimension_t i = 0; i < one.dimension(); i++) {
+            for (dimension_t k = 0; k <= i; k++) {
+                T scalar = one[i][k];
+                for (dimension_t j = 0; j < two.numOfCols(); j++) {
+                    prod[i][j] += scalar * two[k][j];
+                }
+            }
+        }
+        return prod;
+    }
+
+    // Multiplication operator -- upper triangular applied to a matrix
+    template <typename T>
+    matrix<T> operator * (const upper_triangular<T> &one, const matrix<T> &two) {
+        if (one.dimension() != two.numOfRows()) {
+            std::cerr << "Error: cannot multiply matrices\n"
+                      << "Columns and rows of instances do not match"
+                      << std::endl;
+            return matrix<T>(1, 1);
+        }
+        matrix<T> prod(one.dimension(), two.numOfCols());
+
+        prod.init((T) 0);
+
+        for (dimension_t i = 0; i < one.dimension(); i++) {
+            for (dimension_t k = i; k < one.dimension(); k++) {
+                T scalar = one[i][k];
+                for (dimension_t j = 0; j < two.numOfCols(); j++) {
+                    prod[i][j] += scalar * two[k][j];
+                }
+            }
+        }
+        return prod;
+    }
+
+    // Output stream operators
+    template <typename T>
+    std::ostream &operator << (std::ostream &os, const lower_triangular<T> &arg) {
+        for (dimension_t i = 0; i < arg.dimension(); ++i) {
+            os << "|";
+            for (dimension_t j = 0; j < arg.dimension(); ++j) {
+                os << std::setw(4) << std::setfill(' ') << arg.at(i, j) << " ";
+            }
+            os << "|" << std::endl;
+        }
+        return os;
+    }
+
+    template <typename T>
+    std::ostream &operator << (std::ostream &os, const upper_triangular<T> &arg) {
+        for (dimension_t i = 0; i < arg.dimension(); ++i) {
+            os << "|";
+            for (dimension_t j = 0; j < arg.dimension(); ++j) {
+                os << std::setw(4) << std::setfill(' ') << arg.at(i, j) << " ";
+            }
+            os << "|" << std::endl;
+        }
+        return os;
+    }
+}
+
+
+#endif // TRIANGULAR_H